@@ -0,0 +1,41 @@
+// ------------------------------------------------------------------------------
+// Memory tracker
+// ------------------------------------------------------------------------------
+// The tracking allocator behind the raylib's 'RL_MALLOC', 'RL_CALLOC', 'RL_REALLOC' and 'RL_FREE'.
+// The general idea is as follows:
+// - raylib's sources are compiled with this header force-included and with the 'MEMORY_TRACKER_HOOK_RAYLIB' defined (check the 'CMakeLists.txt'),
+//   so the hooks below are defined before the raylib's defaults ('#ifndef RL_MALLOC ...') and every raylib's allocation goes through us;
+// - our own allocations are the raylib's 'MemAlloc' / 'MemFree', so they're counted as well;
+// - every block carries a small header with its size, so the freed bytes can be counted too;
+// - the counters are only ever growing (and atomic, the job workers and the audio thread are allocating as well),
+//   so the per-frame and the per-state numbers are just the differences of two snapshots (check the 'MemoryStats' in the 'main.c').
+// ------------------------------------------------------------------------------
+
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t allocation_count; // Every successful malloc, calloc and realloc
+    uint64_t allocation_bytes; // Bytes requested by all of them
+    uint64_t free_count;
+    int64_t live_bytes; // Bytes that are still allocated
+} MemoryTrackerStats;
+
+void* memoryTrackerMalloc(size_t size);
+void* memoryTrackerCalloc(size_t count, size_t size);
+void* memoryTrackerRealloc(void* pointer, size_t size);
+void memoryTrackerFree(void* pointer);
+
+MemoryTrackerStats memoryTrackerGetStats();
+
+#if defined(MEMORY_TRACKER_HOOK_RAYLIB)
+    #define RL_MALLOC(size) memoryTrackerMalloc(size)
+    #define RL_CALLOC(count, size) memoryTrackerCalloc(count, size)
+    #define RL_REALLOC(pointer, size) memoryTrackerRealloc(pointer, size)
+    #define RL_FREE(pointer) memoryTrackerFree(pointer)
+#endif
+
+#endif // MEMORY_TRACKER_H
@@ -27,12 +27,50 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdatomic.h>
 #include <math.h>
 
+#if !defined(__EMSCRIPTEN__)
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+
+    // Without the threads (Web), the queued jobs are executed on the main thread, one per frame
+    #define JOB_SYSTEM_THREADED
+#endif
+
 #include "raylib.h"
 #include "raymath.h"
 #include "rlgl.h"
 
+#include "memory_tracker.h"
+
+#if defined(__EMSCRIPTEN__)
+    // WebGL 1.0 (GLSL ES 1.00)
+    #define SHADER_GLSL_HEADER \
+        "#version 100\n" \
+        "#ifdef GL_FRAGMENT_PRECISION_HIGH\n" \
+        "precision highp float;\n" \
+        "#else\n" \
+        "precision mediump float;\n" \
+        "#endif\n" \
+        "#define IN varying\n" \
+        "#define TEXTURE texture2D\n" \
+        "#define FRAG_COLOR gl_FragColor\n"
+#else
+    // OpenGL 3.3 (GLSL 3.30); also available on the software implementations (e.g. Mesa's llvmpipe)
+    #define SHADER_GLSL_HEADER \
+        "#version 330\n" \
+        "#define IN in\n" \
+        "#define TEXTURE texture\n" \
+        "#define FRAG_COLOR finalColor\n" \
+        "out vec4 finalColor;\n"
+#endif
+
 // macro deffinitions
 #define GAME_TITLE "Floppy Submarine"
 #define GAME_RESUME_TIME 3.0f
@@ -47,24 +85,92 @@
 #define PLAYER_GRAVITY_X 0.0
 #define PLAYER_GRAVITY_Y 24.0
 #define PLAYER_SPEED 512.0f
+#define PLAYER_REFERENCE_FPS 60.0f // The player's velocity is in world units per frame of this rate (the physics was tuned at it)
+
+#define SIMULATION_TICK_RATE 240 // Rate of the fixed-step gameplay simulation (ticks per second, independent of the frame rate)
+#define SIMULATION_STEP (1.0f / SIMULATION_TICK_RATE)
+#define SIMULATION_TICKS_MAX 16 // Ticks a single frame can run (the rest of a longer hitch is dropped, so the simulation never spirals)
 
 #define COLLECTLIBLE_RADIUS 16.0f
 #define COLLECTIBLE_SPAWN_CHANCE 2 // What's the chance in between 0 - COLLECTIBLE_SPAWN_CHANCE for this to happen
 #define COLLECTIBLE_SPAWN_CHANCE_VALUE 0 // What's the exact value that must be picked by the 0 - COLLECTIBLE_SPAWN_CHANCE random number generation
+#define COLLECTIBLE_DRIFT 0.1f // How quickly the collectible drifts towards the lower point of its obstacle (the fraction of the remaining distance per second)
+
+#define ENTITY_CAPACITY 4096 // The most entities that can be alive at once (the handles keep the slot in 16 bits, so it can't go above 65536)
+#define ENTITY_SPAWN_CAPACITY 4 // The most entities a single obstacle can spawn
+#define ENTITY_TYPE_POINTS { 1, 2, 4 } // Points the player gets for picking up every 'EntityType'
+#define ENTITY_TYPE_DRAG { COLLECTIBLE_DRIFT, COLLECTIBLE_DRIFT, COLLECTIBLE_DRIFT } // How quickly the velocity of every 'EntityType' fades (the fraction of it per second)
+
+#define SPATIAL_GRID_CELL_SIZE 64.0f // Side of a grid cell (in world units; a few entity radii, so a player-sized query touches only a few cells)
+#define SPATIAL_GRID_BUCKET_COUNT 4096 // Hash buckets the cells are mapped to (must be a power of two; as many as the entities, so the buckets stay short)
+#define SPATIAL_GRID_QUERY_CAPACITY 64 // The most entities a single gameplay query returns
 
 #define OBSTACLE_CAPACITY 8 // The size of the Obstacle buffer (where all the obstacle objects are stored)
 #define OBSTACLE_WIDTH 512
-#define OBSTACLE_DIST_INITIAL (renderGetSize().y - 128.0f)
+#define OBSTACLE_DIST_INITIAL (WORLD_HEIGHT - 128.0f)
 #define OBSTACLE_DIST_REDUCTION 4
 #define OBSTACLE_DIST_MIN 160.0f
 #define OBSTACLE_UPPER_COLOR 0x7f708aff
+#define OBSTACLE_UPPER_COLOR_TOP 0x3e3546ff // The upper wall's gradient goes from this color (top of the world) to the 'OBSTACLE_UPPER_COLOR'
 #define OBSTACLE_LOWER_COLOR 0xf9c22bff
+#define OBSTACLE_LOWER_COLOR_BOTTOM 0xf79617ff // The lower wall's gradient goes from the 'OBSTACLE_LOWER_COLOR' to this color (bottom of the world)
+#define OBSTACLE_LINE_THICKNESS 4
+#define OBSTACLE_SEGMENT_RESOLUTION (OBSTACLE_WIDTH / 2) // Number of the spline steps in between two obstacles (used to build the heightfield)
+#define OBSTACLE_HEIGHTFIELD_STEP 2 // Width of a single heightfield bucket (in world units)
+#define OBSTACLE_HEIGHTFIELD_RESOLUTION (OBSTACLE_WIDTH / OBSTACLE_HEIGHTFIELD_STEP) // Number of the heightfield buckets in between two obstacles
+#define OBSTACLE_STREAM_CAPACITY 16 // How many obstacles can be generated ahead of the camera (must be a power of two)
 
 #define RESOURCES_SPRITE_PLAYER GlobalState.Resources.texture_player
 #define RESOURCES_SPRITE_COLLECTIBLES GlobalState.Resources.texture_collectibles
 #define RESOURCES_FONT_DEFAULT GlobalState.Resources.font_game_default
 #define RESOURCES_FONT_LARGE GlobalState.Resources.font_game_large
 
+#define BACKGROUND_LAYER_CAPACITY 4
+
+#define RENDER_STRIP_WIDTH 32 // Width of the corridor strips that clip the background and the shader walls (must divide the 'OBSTACLE_WIDTH')
+#define RENDER_STRIP_CAPACITY ((int) WORLD_WIDTH / RENDER_STRIP_WIDTH + 2)
+#define RENDER_STRIP_MARGIN (OBSTACLE_LINE_THICKNESS * 2.0f) // The strips are extended by this much, so the outlines always have something underneath
+
+#define OVERDRAW_COUNT_STEP 8 // How much every shaded fragment adds to the overdraw counter (out of 255, so up to 31 layers can be counted)
+#define OVERDRAW_HEATMAP_LEVELS 7
+#define OVERDRAW_HEATMAP_COLORS { 0x000000ff, 0x1c3f94ff, 0x2b9348ff, 0xf5d90aff, 0xf08c00ff, 0xe03131ff, 0xffffffff } // 0, 1, 2, 3, 4, 5 and 6+ layers
+
+#define SPLINE_SEGMENT_RESOLUTION OBSTACLE_SEGMENT_RESOLUTION // Fixed number of steps of every spline segment (the basis tables are built for it)
+
+#define INPUT_QUEUE_CAPACITY 64 // Button events waiting for the simulation (the oldest are dropped, only their state is kept)
+#define INPUT_LATENCY_CAPACITY 512 // How many of the latest latency measurements are kept for the percentiles
+#define INPUT_LOW_LATENCY_FPS 60 // Frame limit of the low-latency mode, when the monitor's refresh rate is unknown
+
+#define AUTOPILOT_LOOKAHEAD 96.0f // How far ahead of the player the autopilot reads the corridor (in world units)
+#define AUTOPILOT_REACTION 8.0f // How many frames ahead the autopilot extrapolates the player's height (the velocity is per frame)
+
+#define FLOATING_ORIGIN_THRESHOLD 65536.0f // (2^16) Once the camera gets this far, the whole simulation is shifted back towards the origin
+#define FLOATING_ORIGIN_STEP OBSTACLE_WIDTH // The shift is always a multiple of this (the obstacles and the post-processing patterns stay aligned)
+#define FLOATING_ORIGIN_GRID 128.0f // The horizontal motion is snapped to 1/128 of a unit, so it adds up exactly anywhere below 2^17 (the shift changes nothing)
+
+#define REWIND_KEY KEY_R // Held during the gameplay (or on the game-over screen) rewinds the simulation
+#define REWIND_SPEED 2.0f // How many ticks are rewound per one tick of the real time
+#define REWIND_RECORD_CAPACITY (SIMULATION_TICK_RATE * 15) // Longest history the rewind can hold (in ticks; the oldest are dropped)
+#define REWIND_BUFFER_SIZE (4 * 1024 * 1024) // Bytes of the compressed deltas (when they don't fit, the oldest are dropped as well)
+#define REWIND_COST_SMOOTHING 0.01f // How quickly the averaged cost of the snapshot follows the current one
+
+#define FRAME_ARENA_CAPACITY (256 * 1024) // Bytes of the transient data a single frame can use (the visible lists, the HUD and the overlay strings)
+#define FRAME_ARENA_ALIGNMENT 16
+
+#define TRACE_EVENT_CAPACITY (1 << 17) // Events kept by every thread (the oldest are overwritten; ~1 minute of the main thread's history)
+#define TRACE_STACK_CAPACITY 32 // Maximal nesting of the trace scopes
+#define TRACE_THREAD_CAPACITY (JOB_WORKER_CAPACITY + 1) // Main thread + the workers
+
+#define JOB_QUEUE_CAPACITY 256 // Capacity of every thread's job queue
+#define JOB_WORKER_CAPACITY 8
+#define JOB_CONTINUATION_CAPACITY 8 // How many jobs can wait for a single counter
+
+#define RESOURCES_REQUEST_CAPACITY 16
+#define RESOURCES_FONT_GLYPH_COUNT 256
+#define RESOURCES_FONT_GLYPH_PADDING 4 // The same padding that raylib uses for the TTF fonts
+
+#define WELCOME_SCREEN_TIME 2.0f // Minimal time of the welcome screen (the last second is the fade-out)
+
 #define PARTICLES_CAPACITY 128
 #define PARTICLE_GRAVITY_X 0.0
 #define PARTICLE_GRAVITY_Y -2.0f
@@ -75,10 +181,56 @@
 #define MUSIC_VOLUME_GAME_OVER 0.1f
 #define MUSIC_VOLUME_MUTED 0.0f
 
+#define SCHEDULER_FULL_FPS 0 // 0 - no frame limit (the frame rate is driven by the V-Sync)
+#define SCHEDULER_IDLE_FPS 15 // Tick rate of the static screens and of the unfocused window
+#define SCHEDULER_WAKE_TIME 1.0f // How long after the last input we're staying at the full rate
+#define SCHEDULER_AUDIO_BUFFER_SIZE 4410 // Music stream sub-buffer (in frames); big enough to survive the idle tick rate without the underruns
+
+#define WORLD_WIDTH 1280.0f // The size of the visible world (in world units); all the gameplay and HUD coordinates are using this space
+#define WORLD_HEIGHT 768.0f
+
+#define RENDER_SCALE_LEVELS { 1.0f, 0.75f, 0.5f } // Available internal resolutions (as a fraction of the full resolution)
+#define RENDER_SCALE_LEVEL_COUNT 3
+#define RENDER_SCALE_TARGET_FPS 60.0f
+#define RENDER_SCALE_SMOOTHING 0.05f // How quickly the averaged frame time follows the current frame time
+#define RENDER_SCALE_OVERLOAD 1.15f // If the averaged frame time is above 'target * RENDER_SCALE_OVERLOAD', we drop to the lower resolution
+#define RENDER_SCALE_HEADROOM 1.05f // If the averaged frame time is below 'target * RENDER_SCALE_HEADROOM', we can try the higher resolution
+#define RENDER_SCALE_COOLDOWN 1.0f // Minimal time in between two resolution changes
+#define RENDER_SCALE_RECOVERY_DELAY 3.0f // How long we need to stay in the headroom before trying the higher resolution
+#define RENDER_SCALE_RECOVERY_DELAY_MAX 48.0f
+
+#define ANTI_ALIASING_DEFAULT ANTI_ALIASING_FXAA // Used when the FXAA shader is available (the other modes can be picked at runtime)
+#define FXAA_SPAN_MAX 8.0 // The furthest (in texels) the FXAA looks along the edge
+#define FXAA_REDUCE_MUL (1.0 / 8.0) // (Pasted into the GLSL ES source, so no float suffixes)
+#define FXAA_REDUCE_MIN (1.0 / 128.0)
+
+#define POST_FOG_DIVISOR 4 // Resolution of every post-processing pass (1 - full, 2 - half, 4 - quarter of the render resolution)
+#define POST_WOBBLE_DIVISOR 4
+#define POST_CAUSTICS_DIVISOR 2
+#define POST_BLOOM_DIVISOR 4
+#define POST_PATTERN_PERIOD 512.0 // Horizontal period of the caustics and the wobble (in world units), so the shaders only get the camera position modulo this
+#define POST_WOBBLE_AMPLITUDE 2.0f // How far the refraction wobble moves the image (in world units)
+#define POST_BUDGET_OVERLOAD RENDER_SCALE_OVERLOAD // Above this, the passes are suspended one by one (before the render scaler drops the resolution)
+#define POST_BUDGET_HEADROOM RENDER_SCALE_HEADROOM
+#define POST_BUDGET_COOLDOWN 0.5f // Minimal time in between two pass suspensions
+#define POST_BUDGET_RECOVERY_DELAY 3.0f // How long we need to stay in the headroom before resuming a suspended pass
+#define POST_COST_SMOOTHING 0.05f // How quickly the averaged cost of the passes follows the current one
+
 #define MATH_MIN(a, b) { a < b ? a : b }
+#define STRINGIFY(x) #x
+#define STRINGIFY_VALUE(x) STRINGIFY(x) // Pastes the value of the macro into the string literal (used by the shaders' sources)
 
 #define internal static
 
+// Trace scopes (check the 'TraceBuffer'); they're compiled out completely without the 'TRACE_ENABLED'
+#if defined(TRACE_ENABLED)
+    #define TRACE_BEGIN(name) traceBegin(name)
+    #define TRACE_END() traceEnd()
+#else
+    #define TRACE_BEGIN(name)
+    #define TRACE_END()
+#endif
+
 typedef struct {
     float time_initial;
     float time_current;
@@ -90,6 +242,24 @@ bool timerFinished(Timer* timer);
 void timerRestart(Timer* timer);
 void timerReset(Timer* timer, float time);
 
+typedef struct {
+    uint32_t state;
+} Random; // Small xorshift generator; unlike 'GetRandomValue' it can be owned by a single system (and used from the worker threads)
+
+Random randomInit(uint32_t seed);
+uint32_t randomNext(Random* random);
+int randomGetValue(Random* random, int min, int max);
+
+typedef struct {
+    // Bernstein weights of the cubic Bezier for every fixed 't' of the segment ('i / SPLINE_SEGMENT_RESOLUTION').
+    // They don't depend on the control points, so they're computed only once (check the 'splineBasisInit').
+    float weights[SPLINE_SEGMENT_RESOLUTION + 1][4];
+} SplineBasis;
+
+SplineBasis splineBasisInit();
+void splineEvaluateBasis(SplineBasis* basis, Vector2 p1, Vector2 c2, Vector2 c3, Vector2 p4, Vector2* samples);
+void splineEvaluateForward(Vector2 p1, Vector2 c2, Vector2 c3, Vector2 p4, Vector2* samples);
+
 typedef enum {
     STATE_WELCOME_SCREEN,
     STATE_START,
@@ -99,8 +269,12 @@ typedef enum {
     STATE_RESUME
 } GameplayStateMachine;
 
+#define STATE_COUNT (STATE_RESUME + 1)
+
 const char* stateMachineGetName();
 void stateMachineSet(GameplayStateMachine state_machine);
+bool stateMachineIsFrozen();
+bool stateMachineIsStatic();
 
 typedef struct {
     Vector2 position;
@@ -117,14 +291,85 @@ typedef struct {
     Timer spawn_timer;
 
     float initial_particle_velocity_force;
-    Vector2* particle_system_target;
+    Vector2 target; // Where the new particles are spawned (a copy of the owner's position, so the system can be snapshotted as it is)
 
     int current_particle_index;
+
+    Random random;
 } ParticleSystem;
 
-ParticleSystem particleSystemInit(Vector2* target, float spawn_time, float velocity_force);
+ParticleSystem particleSystemInit(Vector2 target, float spawn_time, float velocity_force);
 void particleSystemUpdate(ParticleSystem* particle_system);
-void particleSystemRender(ParticleSystem* particle_system);
+void particleSystemUpdateJob(void* data);
+void particleSystemRender(ParticleSystem* particle_system, const int* visible, int visible_count);
+int particleSystemCull(ParticleSystem* particle_system, Rectangle bounds, int* visible);
+
+typedef enum {
+    ENTITY_COLLECTIBLE_COMMON = 0,
+    ENTITY_COLLECTIBLE_RARE,
+    ENTITY_COLLECTIBLE_LEGENDARY,
+    ENTITY_TYPE_COUNT
+} EntityType;
+
+typedef struct {
+    // A single entity outside of the store (what's spawned into it)
+    Vector2 position;
+    float rotation;
+    Vector2 velocity;
+    float radius;
+    uint8_t sprite;
+    uint8_t type;
+} Entity;
+
+typedef uint32_t EntityHandle; // Slot in the low 16 bits, slot's generation in the high 16 bits (0 - no entity)
+
+typedef struct {
+    // Structure of arrays, the alive entities are packed at the start; the handles survive the moves (slot + generation)
+    Vector2 position[ENTITY_CAPACITY]; // Transform
+    float rotation[ENTITY_CAPACITY];
+    Vector2 velocity[ENTITY_CAPACITY];
+    float radius[ENTITY_CAPACITY]; // Collider (a circle)
+    uint8_t sprite[ENTITY_CAPACITY]; // Index into the 'texture_collectibles' (the only entity sprites so far)
+    uint8_t type[ENTITY_CAPACITY]; // 'EntityType'
+    uint16_t slot[ENTITY_CAPACITY]; // Slot of every packed entity (updated when the entity is moved)
+    int count;
+
+    uint16_t slot_index[ENTITY_CAPACITY]; // Where the slot's entity is packed (or the next free slot + 1, while the slot is on the free-list)
+    uint16_t slot_generation[ENTITY_CAPACITY];
+    int slot_count; // Slots that were ever used (the ones after them are still fresh)
+    int free_first; // First free slot + 1 (0 - the free-list is empty)
+} EntityStore;
+
+EntityHandle entityStoreAdd(EntityStore* store, Entity entity);
+int entityStoreFind(EntityStore* store, EntityHandle handle);
+EntityHandle entityStoreGetHandle(EntityStore* store, int index);
+void entityStoreRemove(EntityStore* store, EntityHandle handle);
+void entityStoreRemoveAt(EntityStore* store, int index);
+void entityStoreRemoveBehind(EntityStore* store, float x);
+void entityStoreUpdate(EntityStore* store, float step);
+void entityStoreShift(EntityStore* store, float shift);
+int entityStoreCull(EntityStore* store, Rectangle bounds, int* visible);
+void entityStoreRender(EntityStore* store, const int* visible, int visible_count);
+
+typedef struct {
+    // Entities counting-sorted by the hashed cell under their center, so a query only walks the buckets under its rectangle
+    // (Derived from the entity store every tick, so it's not a part of the 'SimulationState')
+    int bucket_start[SPATIAL_GRID_BUCKET_COUNT + 1]; // Entries of the bucket 'n' are in between the 'bucket_start[n]' and the 'bucket_start[n + 1]'
+
+    int entry_index[ENTITY_CAPACITY]; // Index of the entity in the store
+    uint32_t entry_cell[ENTITY_CAPACITY]; // The entry's cell (x in the low 16 bits, y in the high 16 bits; the cells sharing a bucket are told apart by it)
+    Vector2 entry_position[ENTITY_CAPACITY];
+    float entry_radius[ENTITY_CAPACITY];
+    uint16_t entity_bucket[ENTITY_CAPACITY]; // Bucket and cell of every entity (in the store's order; kept in between the passes of the sort)
+    uint32_t entity_cell[ENTITY_CAPACITY];
+    int entry_count;
+
+    float radius_max; // The entities are binned by their centers, so every query is grown by the largest radius
+} SpatialGrid;
+
+void spatialGridBuild(SpatialGrid* grid, EntityStore* store);
+int spatialGridQuery(SpatialGrid* grid, Rectangle rect, int* results, int capacity);
+int spatialGridQueryCircle(SpatialGrid* grid, Vector2 center, float radius, int* results, int capacity);
 
 typedef struct Player {
     ParticleSystem particle_system;
@@ -138,14 +383,12 @@ typedef struct Player {
     float sprite_rotation;
 
     uint32_t points;
-    uint32_t collected_common;
-    uint32_t collected_rare;
-    uint32_t collected_legendary;
+    uint32_t collected[ENTITY_TYPE_COUNT]; // Picked up entities of every type
     bool game_over; // You crash once - this value is set to true;
 } Player;
 
 Player playerInit(Vector2 position);
-void playerUpdate();
+void playerUpdate(float step, float held_time);
 void playerRender();
 void playerRenderScore(Vector2 position, Vector2 text_offset);
 bool playerInputGetPress();
@@ -158,21 +401,6 @@ void playerSetVelocity(Vector2 velocity);
 
 void playerCheckCollisions();
 
-typedef enum {
-    COLLECTIBLE_COMMON = 0,
-    COLLECTLIBLE_RARE,
-    COLLECTLIBLE_LEGENDARY,
-    COLLECTIBLE_RARITY_COUNT
-} CollectibleRarity;
-
-typedef struct {
-    CollectibleRarity collectible_rarity;
-
-    float sprite_rotation;
-
-    Vector2 position;
-} Collectible;
-
 typedef struct Obstacle {
     // The general idea is as follows:
     // There're two points, 'point0' & 'point1', which are separated by the 'distance'.
@@ -185,62 +413,548 @@ typedef struct Obstacle {
 
     float distance;
 
-    bool has_collectible;
-    Collectible collectible;
+    // Heightfield of the corridor leading from the previous obstacle to this one (one bucket per 'OBSTACLE_HEIGHTFIELD_STEP' units).
+    // 'height0' is the lowest point of the upper wall and 'height1' is the highest point of the lower wall within the bucket.
+    // It's built together with the obstacle, so the rendering and the collisions are only reading it.
+    float height0[OBSTACLE_HEIGHTFIELD_RESOLUTION];
+    float height1[OBSTACLE_HEIGHTFIELD_RESOLUTION];
 } Obstacle;
 
-Obstacle obstacleInit(Vector2 position, float distance, bool spawn_collectible);
+Obstacle obstacleInit(Vector2 position, float distance);
+void obstacleBuildHeightfield(Obstacle* obstacle, Obstacle* obstacle_prev);
 
-Collectible collectibleInit(Obstacle* obstacle);
-void collectibleUpdate(Obstacle* obstacle);
-void collectibleRender(Obstacle* obstacle);
+int collectibleSpawn(Obstacle* obstacle, Random* random, Entity* spawns);
 
 typedef struct ObstacleList {
     Obstacle list[OBSTACLE_CAPACITY];
+
+    // Generator's state right after the last obstacle of the list.
+    // The generation is deterministic, so the stream can be restarted from here after the list is restored (check the 'simulationRestore').
+    Random random;
+    int generated_count;
 } ObstacleList;
 
-ObstacleList obstacleListInit();
-void obstacleInitData(Obstacle* obstacle, Vector2* position, float* distance);
-void obstacleListUpdate();
+ObstacleList obstacleListInit(EntityStore* entities);
+void obstacleInitData(Obstacle* obstacle, Vector2* position, float* distance, Random* random);
 void obstacleListRender();
+void obstacleListRenderWalls();
+int obstacleListCullSegments(Rectangle bounds, int* visible);
+bool obstacleListGetCorridor(float left, float right, float* top, float* bottom);
 void obstacleListLoopObstacles();
 
 typedef struct {
-    Vector2 bg_pos0; // this is the position of the first rendered texture
-    Vector2 bg_pos1; // this is the position of the second rendered texture
+    Texture2D texture;
+    Color tint;
 
-    // Both textures will be rendered at the same time.
-    // What's important is that if on of them will be out of bounds (the whole texture isn't visible on the screen),
-    // then we'll move it next to the other vector (plus the size that we use for rendering).
+    // How fast the layer scrolls compared to the world (1.0 - together with the world, 0.0 - static, in between - parallax depth)
+    float scroll_factor;
+
+    // Horizontal texture offset (in texture pixels) derived from the camera position.
+    // The layer is always rendered as a single, screen-sized quad and the texture wrapping does the rest.
     // (Check the 'backgroundUpdate' for more information about how it works).
+    float uv_offset;
+} BackgroundLayer;
+
+typedef struct {
+    BackgroundLayer layers[BACKGROUND_LAYER_CAPACITY]; // Layers are rendered from the first (the farthest) to the last (the closest)
+    int layer_count;
 } Background;
 
 Background backgroundInit();
+bool backgroundAddLayer(Background* background, Texture2D texture, float scroll_factor, Color tint);
 void backgroundUpdate(Background* background);
+void backgroundUpdateJob(void* data);
 void backgroundRender(Background* background);
 
+typedef struct {
+    // The visible segments are uploaded as the uniforms, and the whole corridor is a single quad (check the 'CORRIDOR_FRAGMENT_SHADER')
+    Shader shader;
+
+    int location_rect;
+    int location_obstacles;
+    int location_colors;
+
+    bool ready; // The shader compiled (otherwise the CPU renderer is always used)
+    bool enabled; // The shader renderer is used instead of the CPU one
+} CorridorRenderer;
+
+CorridorRenderer corridorRendererInit();
+void corridorRendererRender(CorridorRenderer* renderer);
+void corridorRendererUnload(CorridorRenderer* renderer);
+
+typedef struct {
+    // Vertical extents of the corridor within a 'RENDER_STRIP_WIDTH' wide strip (taken from the heightfield).
+    // The upper wall never goes below the 'ceiling_max' and the open corridor is always in between the 'ceiling_min' and the 'floor_max',
+    // so the background is drawn only in the open part and the walls only where they can be (most of the screen is covered exactly once).
+    float x;
+    float width;
+
+    float ceiling_min;
+    float ceiling_max;
+    float floor_min;
+    float floor_max;
+
+    bool has_walls; // The strip is outside of the corridor (there's only the open water)
+} CorridorStrip;
+
+int obstacleListCullStrips(Rectangle bounds, CorridorStrip* strips, int capacity);
+
+typedef struct {
+    // Bump allocator, reset at the top of every frame (main thread only)
+    unsigned char* memory;
+    size_t capacity;
+    size_t used;
+
+    size_t used_last; // Used by the last finished frame
+    size_t high_water; // The most any frame has ever asked for (including the requests that didn't fit)
+    size_t requested; // Asked for in the current frame (the same as 'used', unless something didn't fit)
+} FrameArena;
+
+FrameArena frameArenaInit(size_t capacity);
+void frameArenaReset(FrameArena* arena);
+void* frameArenaPush(FrameArena* arena, size_t size);
+const char* frameArenaFormat(FrameArena* arena, const char* format, ...);
+void frameArenaUnload(FrameArena* arena);
+
+typedef struct {
+    // Compact lists of the things that are inside of the camera's bounds (one list per render layer).
+    // They're rebuilt before every world render, so the renderers never touch the off-screen objects.
+    // The lists are allocated from the frame arena, so they're valid only until the end of the frame.
+    Rectangle bounds; // Camera's bounds (in world units)
+
+    int* segments; // Index 'n' - segment in between the 'list[n]' and the 'list[n + 1]' (up to 'OBSTACLE_CAPACITY - 1')
+    int segment_count;
+
+    int* entities; // Up to 'ENTITY_CAPACITY' (indices into the entity store's arrays)
+    int entity_count;
+
+    int* particles; // Up to 'PARTICLES_CAPACITY'
+    int particle_count;
+
+    CorridorStrip* strips; // Up to 'RENDER_STRIP_CAPACITY'
+    int strip_count;
+} RenderVisibility;
+
+RenderVisibility renderVisibilityBuild(FrameArena* arena, Rectangle bounds);
+
+typedef struct {
+    // Every fragment adds to the red channel of the 'target', and the heat-map shader colors the counts
+    RenderTexture2D target;
+
+    Shader shader_count;
+    Shader shader_heatmap;
+    int location_colors;
+
+    bool ready; // Both shaders compiled
+    bool active; // The world is being rendered into the 'target' right now (the renderers must keep the counting shader)
+} OverdrawView;
+
+OverdrawView overdrawViewInit();
+void overdrawViewUpdate(OverdrawView* view);
+void overdrawViewRender(OverdrawView* view);
+void overdrawViewUnload(OverdrawView* view);
+
+typedef struct {
+    int target_fps; // Currently applied frame limit (-1 - not applied yet)
+    float wake_time; // Time left at the full rate since the last input
+
+    bool waiting_events; // The window is hidden and we're blocking until it receives an event
+} FrameScheduler;
+
+FrameScheduler frameSchedulerInit();
+void frameSchedulerUpdate(FrameScheduler* scheduler);
+bool frameSchedulerIsFullRate(FrameScheduler* scheduler);
+bool frameSchedulerInputActive();
+
+typedef struct {
+    int level; // Index of the currently used render scale level (0 - full resolution)
+
+    float frame_time_average;
+    float cooldown;
+    float headroom_time;
+    float recovery_delay;
+    float time_since_upgrade;
+} RenderScaler;
+
+RenderScaler renderScalerInit();
+void renderScalerUpdate(RenderScaler* render_scaler);
+float renderScalerGetScale(RenderScaler* render_scaler);
+
+typedef enum {
+    ANTI_ALIASING_NONE,
+    ANTI_ALIASING_FXAA,
+    ANTI_ALIASING_MODE_COUNT
+} AntiAliasingMode;
+
+typedef struct {
+    // Applied by the upscaling blit of the 'render_texture' (the window's framebuffer never sees any geometry)
+    Shader shader_fxaa;
+    int location_texel_size;
+
+    AntiAliasingMode mode;
+    bool ready; // The FXAA shader compiled (otherwise the anti-aliasing is always off)
+} AntiAliasing;
+
+AntiAliasing antiAliasingInit();
+void antiAliasingCycle(AntiAliasing* anti_aliasing);
+void antiAliasingRender(AntiAliasing* anti_aliasing, Texture2D texture, Rectangle destination);
+const char* antiAliasingGetName(AntiAliasing* anti_aliasing);
+void antiAliasingUnload(AntiAliasing* anti_aliasing);
+
+typedef enum {
+    // The passes are ordered by their importance: the budget suspends them from the last one and resumes them from the first one
+    POST_PASS_FOG,
+    POST_PASS_WOBBLE,
+    POST_PASS_CAUSTICS,
+    POST_PASS_BLOOM,
+    POST_PASS_COUNT
+} PostPassType;
+
+typedef struct {
+    Shader shader;
+    RenderTexture2D target; // Render resolution divided by the 'divisor'
+
+    int location_world_rect;
+    int location_time;
+
+    int divisor;
+    bool suspended; // Turned off by the budget (check the 'postProcessUpdateBudget')
+
+    float cost; // Averaged CPU time of the pass (in milliseconds)
+} PostPass;
+
+typedef struct {
+    // Low-resolution layers, applied to the world by the single full-resolution composite (the HUD is drawn after it)
+    PostPass passes[POST_PASS_COUNT];
+
+    Shader shader_composite;
+    int location_layers[POST_PASS_COUNT];
+    int location_layer_sizes;
+    int location_layer_enabled;
+    int location_wobble_scale;
+    int location_collectibles; // Bloom pass
+    int location_blur_step;
+
+    RenderTexture2D output;
+
+    float frame_time_average;
+    float cooldown;
+    float headroom_time;
+
+    bool ready; // All the shaders compiled (otherwise there's no post-processing)
+    bool enabled;
+} PostProcess;
+
+PostProcess postProcessInit();
+RenderTexture2D* postProcessApply(PostProcess* post_process, RenderTexture2D* source);
+bool postProcessUpdateBudget(PostProcess* post_process, bool resolution_full);
+const char* postProcessGetInfo(PostProcess* post_process);
+void postProcessUnload(PostProcess* post_process);
+
+typedef struct {
+    // Difference of the tracker's snapshots, added to the state the frame was running in (the 'STATE_GAMEPLAY' should stay at zero)
+    MemoryTrackerStats snapshot;
+    GameplayStateMachine snapshot_state;
+
+    uint64_t frame_allocations; // Last finished frame
+    uint64_t frame_bytes;
+
+    uint64_t state_allocations[STATE_COUNT];
+    uint64_t state_bytes[STATE_COUNT];
+    uint64_t state_frames[STATE_COUNT];
+} MemoryStats;
+
+MemoryStats memoryStatsInit();
+void memoryStatsUpdate(MemoryStats* stats);
+
+typedef struct {
+    // A bot for the headless runs: it's holding the button whenever the player is about to sink below the middle of the corridor ahead.
+    // The player's input functions are asking it first (check the 'playerInputGetDown'), so the game loop itself doesn't know about it.
+    bool active;
+    bool down;
+    bool down_prev;
+
+    int gameplay_frames; // Frames played in the 'STATE_GAMEPLAY'
+    int gameplay_frames_limit; // The game quits once they're played (0 - no limit)
+
+    float frame_time; // Simulated time of every frame, so the game runs faster than the real time (0 - the real frame time)
+
+    // Giving up: after a random number of the frames of every game it stops pushing the button, so the submarine sinks into the wall
+    int give_up_frames_min; // (0 - it never gives up)
+    int give_up_frames_max;
+    int give_up_frame;
+    int game_frames; // Frames of the current game
+    Random random;
+} Autopilot;
+
+Autopilot autopilotInit(int gameplay_frames_limit);
+void autopilotUpdate(Autopilot* autopilot);
+
+typedef struct {
+    double time; // When the button changed its state (estimated, check the 'inputQueuePoll')
+    bool down;
+} InputEvent;
+
+typedef struct {
+    float p50;
+    float p95;
+    float p99;
+    int count; // Measurements the percentiles are computed from
+} InputLatencyReport;
+
+typedef struct {
+    // Button edges of every input poll, timestamped as the middle of the polls and consumed by the simulation by the time
+    // (The 'pending' events wait for the frame that applied them to be presented, for the latency measurement)
+    InputEvent events[INPUT_QUEUE_CAPACITY]; // Ring buffer, starting at the 'event_first'
+    int event_first;
+    int event_count;
+
+    bool down; // State after the newest event
+    bool consumed_down; // State after the last consumed event
+    double poll_time;
+
+    double pending[INPUT_QUEUE_CAPACITY];
+    int pending_count;
+
+    float latencies[INPUT_LATENCY_CAPACITY]; // In milliseconds (ring buffer)
+    int latency_count; // All the measurements since the last reset
+} InputQueue;
+
+InputQueue inputQueueInit();
+void inputQueuePoll(InputQueue* queue);
+float inputQueueConsume(InputQueue* queue, double start, double end);
+void inputQueuePresent(InputQueue* queue, double present_time);
+void inputQueueResetLatency(InputQueue* queue);
+InputLatencyReport inputQueueGetLatency(InputQueue* queue, FrameArena* arena);
+void inputSetLowLatency(bool low_latency);
+int inputGetLowLatencyFps();
+
+typedef void (*JobFunction)(void* data);
+
+typedef struct {
+    JobFunction function;
+    void* data;
+    struct JobCounter* counter; // Optional; decremented once the job finishes
+} Job;
+
+typedef struct JobCounter {
+    atomic_int value; // Number of the submitted jobs that haven't finished yet
+
+    // Jobs that are waiting for this counter to reach zero (the edges of the dependency graph).
+    // They're submitted by whichever thread finishes the last job of this counter.
+    Job continuations[JOB_CONTINUATION_CAPACITY];
+    int continuation_count;
+    atomic_flag continuation_lock;
+} JobCounter;
+
+typedef struct {
+    // Double-ended ring-buffer of jobs: the owner pushes and pops at the bottom (LIFO, cache-friendly),
+    // while the other threads steal from the top (FIFO, the oldest - usually the biggest - work first).
+    Job jobs[JOB_QUEUE_CAPACITY];
+    int top;
+    int count;
+
+#if defined(JOB_SYSTEM_THREADED)
+    pthread_mutex_t mutex;
+#endif
+} JobQueue;
+
+typedef struct {
+    JobQueue queues[JOB_WORKER_CAPACITY + 1]; // One queue per thread ('0' - main thread, '1' to 'worker_count' - workers)
+    atomic_int pending_count; // Number of jobs in all the queues
+
+#if defined(JOB_SYSTEM_THREADED)
+    pthread_mutex_t sleep_mutex;
+    pthread_cond_t sleep_condition;
+    pthread_t workers[JOB_WORKER_CAPACITY];
+#endif
+
+    atomic_int worker_count; // (Atomic: the running workers read it while the 'jobSystemInit' might still lower it)
+    atomic_bool running;
+} JobSystem;
+
+void jobSystemInit(JobSystem* job_system);
+void jobSystemShutdown(JobSystem* job_system);
+void jobSystemSubmit(JobSystem* job_system, JobFunction function, void* data, JobCounter* counter);
+void jobSystemSubmitAfter(JobSystem* job_system, JobFunction function, void* data, JobCounter* counter, JobCounter* dependency);
+bool jobSystemHelp(JobSystem* job_system);
+void jobSystemWait(JobSystem* job_system, JobCounter* counter);
+bool jobCounterIsDone(JobCounter* counter);
+
+typedef enum {
+    RESOURCE_TYPE_TEXTURE,
+    RESOURCE_TYPE_FONT,
+    RESOURCE_TYPE_SOUND
+} ResourceType;
+
+typedef struct {
+    // Decoded by the worker thread, uploaded into the 'target' by the main thread
+    ResourceType type;
+    const char* path;
+    void* target; // Texture2D*, Font* or Sound* (depending on the 'type')
+
+    int texture_filter;
+    int texture_wrap;
+    int font_size;
+
+    Image image;
+    GlyphInfo* glyphs;
+    Rectangle* glyph_recs;
+    Wave wave;
+
+    atomic_bool decoded;
+    bool uploaded;
+} ResourceRequest;
+
+typedef struct {
+    ResourceRequest requests[RESOURCES_REQUEST_CAPACITY];
+    int request_count;
+    int uploaded_count;
+
+    JobCounter counter;
+} ResourceLoader;
+
+typedef struct {
+    // Single-producer / single-consumer ring-buffer of the obstacles ahead of the camera
+    Obstacle obstacles[OBSTACLE_STREAM_CAPACITY];
+    Random randoms[OBSTACLE_STREAM_CAPACITY]; // Generator's random state right after every obstacle (handed over to the 'ObstacleList')
+    Entity spawns[OBSTACLE_STREAM_CAPACITY][ENTITY_SPAWN_CAPACITY]; // Entities that come with every obstacle (they're added to the store when it's popped)
+    int spawn_counts[OBSTACLE_STREAM_CAPACITY];
+    atomic_uint head; // Written only by the consumer
+    atomic_uint tail; // Written only by the generator
+
+    // Generator's state (owned by the generator job while it's running)
+    Obstacle obstacle_last;
+    Random random;
+    int generated_count;
+
+    JobCounter counter; // At most one generator job is in flight
+} ObstacleStream;
+
+void obstacleStreamReset(ObstacleStream* stream, Obstacle* obstacle_last, Random random, int generated_count);
+void obstacleStreamRequest(ObstacleStream* stream);
+bool obstacleStreamPop(ObstacleStream* stream, ObstacleList* obstacle_list, int obstacle_index, EntityStore* entities);
+void obstacleStreamGenerateJob(void* data);
+
+typedef struct {
+    // Everything the fixed-step simulation touches, without pointers, so it can be copied around as a single blob (restart, rewind)
+    Player player;
+    Camera2D camera;
+    ObstacleList obstacle_list;
+    EntityStore entities;
+
+    int64_t gameplay_ticks; // (A float clock would lose its precision in the long runs; check the 'simulationGetTime')
+    float accumulator; // Frame time that hasn't been simulated yet (less than a 'SIMULATION_STEP')
+
+    double origin_x; // How far the world was shifted back by the floating origin (the real position is 'origin_x + x'; check the 'floatingOriginUpdate')
+} SimulationState;
+
+// The rewind compares the state word by word (its floats keep the size a multiple of the word anyway)
+_Static_assert(sizeof(SimulationState) % sizeof(uint32_t) == 0, "SimulationState must be a whole number of words");
+
+void simulationRestore(SimulationState* state);
+double simulationGetTime(SimulationState* state);
+
+typedef struct {
+    int offset; // In words, from the start of the 'buffer'
+    int length; // In words
+} RewindRecord;
+
+typedef struct {
+    // Every tick's state XOR-ed with the previous one ('last') and run-length encoded; rewinding applies the newest delta back to the 'last'
+    SimulationState last; // Copy of the simulation state as of the newest record
+
+    uint32_t* buffer;
+    int buffer_capacity; // In words
+    int buffer_write; // Where the next delta starts
+    uint32_t* scratch; // The delta is encoded here first, so its exact length is known before anything is dropped
+
+    RewindRecord records[REWIND_RECORD_CAPACITY]; // Ring-buffer, starting at the 'record_first'
+    int record_first;
+    int record_count;
+
+    float step_accumulator; // Ticks to rewind that haven't been rewound yet (less than one)
+
+    // Instrumentation (for the F3 overlay and the '--benchmark rewind')
+    double push_cost; // Averaged cost of a single snapshot (in microseconds)
+    double push_cost_max;
+    int buffer_used; // In words
+} Rewind;
+
+Rewind rewindInit(int capacity);
+void rewindReset(Rewind* rewind, SimulationState* state);
+void rewindPush(Rewind* rewind, SimulationState* state);
+bool rewindStep(Rewind* rewind);
+bool rewindUpdate(Rewind* rewind);
+void rewindUnload(Rewind* rewind);
+
+typedef struct {
+    const char* name; // Must be a string literal (only the pointer is stored)
+    double start; // In seconds
+    float duration;
+} TraceEvent;
+
+typedef struct {
+    // One buffer per thread, so the recording is lock-free (read only at the exit, after the workers are joined)
+    TraceEvent events[TRACE_EVENT_CAPACITY];
+    uint64_t event_count; // All the events ever recorded (the ring index is 'event_count % TRACE_EVENT_CAPACITY')
+
+    const char* stack_names[TRACE_STACK_CAPACITY];
+    double stack_starts[TRACE_STACK_CAPACITY];
+    int stack_depth;
+} TraceBuffer;
+
+bool traceStart(const char* path);
+void traceBegin(const char* name);
+void traceEnd();
+bool traceWrite();
+
 struct {
     struct {
         GameplayStateMachine gameplay_state_machine;
         RenderTexture2D render_texture;
+        RenderScaler render_scaler;
+        AntiAliasing anti_aliasing;
+        PostProcess post_process;
+        FrameScheduler frame_scheduler;
+
+        // Cached world render, used while the gameplay is frozen (STATE_PAUSE, STATE_RESUME and STATE_GAMEOVER)
+        RenderTexture2D freeze_frame;
+        bool freeze_frame_valid;
 
-        float gameplay_time;
         float resume_countdown;
+        float welcome_screen_time;
+        Timer welcome_screen_timer;
+
+        InputQueue input_queue;
+        bool low_latency; // No V-Sync, and the input is polled right before the frame starts (F7)
 
         bool quit;
         bool start_key_held;
     } Game;
 
     Background background;
-    Player player;
-    Camera2D camera;
-    ObstacleList obstacle_list;
+    CorridorRenderer corridor_renderer;
+    SimulationState simulation;
+    SimulationState simulation_initial; // Taken once the game is initialized; every restart starts from it (check the 'gameRestart')
+    SpatialGrid entity_grid; // Rebuilt from the 'simulation.entities' every tick (check the 'simulationTick')
+    Rewind rewind;
+    ObstacleStream obstacle_stream;
+    RenderVisibility visibility;
+    FrameArena frame_arena;
 
     struct {
         bool render_data;
         bool render_colliders;
+        bool render_overdraw;
+
+        OverdrawView overdraw_view;
+        MemoryStats memory;
     } Debug;
 
+    Autopilot autopilot;
+    bool floating_origin_disabled; // (Only the reference run of the '--soak' plays without the rebasing)
+
     struct {
         Texture2D texture_background;
         Texture2D texture_player;
@@ -256,30 +970,117 @@ struct {
 
         Music music_background;
         float music_background_volume;
+
+        ResourceLoader loader;
     } Resources;
+
+    JobSystem job_system;
+    SplineBasis spline_basis;
+
+    struct {
+        bool enabled;
+        const char* path;
+
+        TraceBuffer* buffers[TRACE_THREAD_CAPACITY]; // Allocated by the 'traceStart' (not during the gameplay)
+    } Trace;
 } GlobalState;
 
+Vector2 worldGetSize();
 Vector2 renderGetSize();
+Rectangle renderGetViewport();
+float renderGetScale();
+void renderUpdateSize();
+Camera2D renderGetWorldCamera();
+Camera2D renderGetScreenCamera();
+Rectangle renderGetWorldBounds();
+void renderWorld();
+void renderUpdateFreezeFrame();
+void renderFreezeFrame();
+bool renderShaderIsReady(Shader shader);
+bool renderTextureFit(RenderTexture2D* target, int width, int height, int filter, int wrap);
+void renderTextureBlit(Texture2D texture, Rectangle destination);
 
 void debugRender();
 void debugRenderData();
 void debugRenderCollisions();
 
+int gameRun();
+void gameOpen();
+void gameFrame();
+void gameClose();
 void gameInit();
+void gameRestart();
+void gameStart();
+void simulationUpdate();
+void simulationTick(float held_time);
+void floatingOriginUpdate();
+void floatingOriginShift(SimulationState* state, float shift);
+float floatingOriginSnap(float x);
 
 void resourcesLoad();
+void resourcesUpdate();
+bool resourcesIsLoaded();
+float resourcesGetProgress();
 void resourcesUnload();
 
+void resourcesRequestTexture(Texture2D* target, const char* path, int filter, int wrap);
+void resourcesRequestFont(Font* target, const char* path, int font_size);
+void resourcesRequestSound(Sound* target, const char* path);
+void resourcesDecodeJob(void* data);
+void resourcesUploadRequest(ResourceRequest* request);
+
 internal bool collisionCheckRectLine(Rectangle rect, Vector2 line_start, Vector2 line_end);
+internal bool collisionCheckCircleRec(Vector2 center, float radius, Rectangle rect);
+internal uint32_t spatialGridHash(int cell_x, int cell_y);
+internal void jobRun(JobSystem* job_system, Job job);
+internal void jobSystemPush(JobSystem* job_system, Job job);
+internal bool jobSystemPop(JobSystem* job_system, Job* job);
+internal bool jobSystemSteal(JobSystem* job_system, Job* job);
+internal void jobCounterLock(JobCounter* counter);
+internal void jobCounterUnlock(JobCounter* counter);
+#if defined(JOB_SYSTEM_THREADED)
+internal int jobSystemGetCoreCount();
+internal void* jobSystemWorker(void* argument);
+#endif
 internal void renderDrawLineGradient(Vector2 start, Vector2 end, int thickness, Color a, Color b);
+internal void rewindDropOldest(Rewind* rewind);
+internal void backgroundRenderLayerRect(BackgroundLayer* layer, Rectangle view, Rectangle destination);
+internal void postProcessSetBloomUniforms(PostProcess* post_process, PostPass* pass, Rectangle bounds, Vector2 source_size);
 
+// (The test harness brings its own 'main', check the 'test/harness.c')
+#if !defined(GAME_HARNESS)
 int main(int argc, char** argv) {
+    GlobalState.spline_basis = splineBasisInit();
+
+    // Game modes:
+    // --trace <path> - records the trace events of the whole session and writes them as the Chrome trace JSON at the exit;
+    if(argc > 2 && TextIsEqual(argv[1], "--trace")) {
+        traceStart(argv[2]);
+    }
+
+    return gameRun();
+}
+#endif
+
+int gameRun() {
+    gameOpen();
+
+    while(!WindowShouldClose() && !GlobalState.Game.quit) {
+        gameFrame();
+    }
+
+    gameClose();
+
+    return 0;
+}
+
+void gameOpen() {
     const char* TITLE = GAME_TITLE;
     const int WIDTH = 1280;
     const int HEIGHT = 768;
 
+    // (No MSAA on the window, the anti-aliasing is done by the final blit - check the 'AntiAliasing')
     ConfigFlags config_flags =
-        FLAG_MSAA_4X_HINT | 
         FLAG_WINDOW_RESIZABLE |
         FLAG_WINDOW_MINIMIZED | 
         FLAG_VSYNC_HINT;
@@ -292,476 +1093,959 @@ int main(int argc, char** argv) {
     InitWindow(WIDTH, HEIGHT, TextFormat("Raylib %s - %s", RAYLIB_VERSION, TITLE));
     InitAudioDevice();
 
+    // Bigger music buffers let us drop the tick rate on the idle screens
+    SetAudioStreamBufferSizeDefault(SCHEDULER_AUDIO_BUFFER_SIZE);
+
     SetExitKey(KEY_NULL);
 
-    GlobalState.Game.render_texture = LoadRenderTexture(WIDTH, HEIGHT);
-    SetTextureFilter(GlobalState.Game.render_texture.texture, TEXTURE_FILTER_BILINEAR);
+    GlobalState.Game.render_scaler = renderScalerInit();
+    GlobalState.Game.anti_aliasing = antiAliasingInit();
+    GlobalState.Game.post_process = postProcessInit();
+    GlobalState.Game.frame_scheduler = frameSchedulerInit();
+    GlobalState.corridor_renderer = corridorRendererInit();
+    GlobalState.Debug.overdraw_view = overdrawViewInit();
+    renderUpdateSize();
 
-    float timer_welcome_screen_time = 5.0f;
-    Timer timer_welcome_screen = timerInit(timer_welcome_screen_time);
+    GlobalState.Game.welcome_screen_time = WELCOME_SCREEN_TIME;
+    GlobalState.Game.welcome_screen_timer = timerInit(WELCOME_SCREEN_TIME);
 
+    // The resources are decoded on the worker threads while the welcome screen is already running.
+    // The game gets initialized as soon as everything is uploaded (check the 'STATE_WELCOME_SCREEN').
+    jobSystemInit(&GlobalState.job_system);
     resourcesLoad();
-    gameInit();
 
     stateMachineSet(STATE_WELCOME_SCREEN);
 
-    while(!WindowShouldClose() && !GlobalState.Game.quit) {
-        // Update your game logic here...
+    GlobalState.frame_arena = frameArenaInit(FRAME_ARENA_CAPACITY);
+    GlobalState.rewind = rewindInit(REWIND_BUFFER_SIZE);
+    GlobalState.Game.input_queue = inputQueueInit();
 
-        // State-Independent update loop...
-        if(IsKeyPressed(KEY_F3)) {
-            GlobalState.Debug.render_data = !GlobalState.Debug.render_data;
-            GlobalState.Debug.render_colliders = !GlobalState.Debug.render_colliders;
-        }
+    // (The window is created with the V-Sync, check the 'config_flags')
+    if(GlobalState.Game.low_latency) {
+        inputSetLowLatency(true);
+    }
 
-        // Window-scaling for render texture
-        // (For how it works check out the raylib's exaples: https://www.raylib.com/examples.html)
-        float scale = MATH_MIN(GetScreenWidth() / renderGetSize().x, GetScreenHeight() / renderGetSize().y);
-        SetMouseOffset((GetScreenWidth() - (renderGetSize().x * scale)) * 0.5f * -1.0, (GetScreenHeight() - (renderGetSize().y * scale)) * 0.5f * -1.0);
-        SetMouseScale(1 / scale, 1 / scale);
-        
-        SetMusicVolume(GlobalState.Resources.music_background, GlobalState.Resources.music_background_volume);
-        UpdateMusicStream(GlobalState.Resources.music_background);
+    // (Everything allocated so far belongs to the initialization, not to the first frame)
+    GlobalState.Debug.memory = memoryStatsInit();
+}
 
-        // State-Dependent update loop...
-        switch (GlobalState.Game.gameplay_state_machine) {
-            case STATE_WELCOME_SCREEN: {
-                timer_welcome_screen_time -= GetFrameTime();
-                timerProceed(&timer_welcome_screen);
+void gameFrame() {
+    memoryStatsUpdate(&GlobalState.Debug.memory);
 
-                if(timerFinished(&timer_welcome_screen) || GetKeyPressed()) {
-                    stateMachineSet(STATE_START);
-                }
+    // Everything transient of the previous frame is gone from here on
+    frameArenaReset(&GlobalState.frame_arena);
 
-                GlobalState.Resources.music_background_volume = Lerp(GlobalState.Resources.music_background_volume, MUSIC_VOLUME_GAME_START, GetFrameTime());
+    TRACE_BEGIN("frame");
 
-            } break;
+    // Update your game logic here...
 
-            case STATE_START: {
+    // State-Independent update loop...
+    TRACE_BEGIN("input");
 
-                if(playerInputGetPress()) {
-                    playerSetVelocity((Vector2) { 0.0f, -PLAYER_GRAVITY_Y * 16.0f * GetFrameTime()});
-                    stateMachineSet(STATE_GAMEPLAY);
-                }
+    autopilotUpdate(&GlobalState.autopilot);
 
-                if(IsKeyPressed(KEY_ESCAPE)) {
-                    GlobalState.Game.quit = true;
-                }
+    // (Right after the autopilot, so its decisions are timestamped the same way as the real button)
+    inputQueuePoll(&GlobalState.Game.input_queue);
+
+    // Cycling the debug views: off -> data + colliders -> data + overdraw heat-map -> off
+    if(IsKeyPressed(KEY_F3)) {
+        if(!GlobalState.Debug.render_data) {
+            GlobalState.Debug.render_data = true;
+            GlobalState.Debug.render_colliders = true;
+        } else if(GlobalState.Debug.render_colliders && GlobalState.Debug.overdraw_view.ready) {
+            GlobalState.Debug.render_colliders = false;
+            GlobalState.Debug.render_overdraw = true;
+        } else {
+            GlobalState.Debug.render_data = false;
+            GlobalState.Debug.render_colliders = false;
+            GlobalState.Debug.render_overdraw = false;
+        }
 
-                GlobalState.Resources.music_background_volume = Lerp(GlobalState.Resources.music_background_volume, MUSIC_VOLUME_GAME_START, GetFrameTime());
+        GlobalState.Game.freeze_frame_valid = false;
+    }
 
-            } break;
+    // Switching in between the CPU and the shader corridor renderer
+    if(IsKeyPressed(KEY_F4) && GlobalState.corridor_renderer.ready) {
+        GlobalState.corridor_renderer.enabled = !GlobalState.corridor_renderer.enabled;
+        GlobalState.Game.freeze_frame_valid = false;
+    }
 
-            case STATE_GAMEPLAY: {
-                playerUpdate();
-                playerCheckCollisions();
-                obstacleListUpdate();
-                backgroundUpdate(&GlobalState.background);
-                GlobalState.camera.target.x += PLAYER_SPEED * GetFrameTime();
-                GlobalState.Game.gameplay_time += GetFrameTime();
+    // Cycling the anti-aliasing modes
+    if(IsKeyPressed(KEY_F5)) {
+        antiAliasingCycle(&GlobalState.Game.anti_aliasing);
+    }
 
-                if(IsKeyPressed(KEY_ESCAPE)) {
-                    stateMachineSet(STATE_PAUSE);
-                }
+    // Switching the post-processing on and off
+    if(IsKeyPressed(KEY_F6) && GlobalState.Game.post_process.ready) {
+        GlobalState.Game.post_process.enabled = !GlobalState.Game.post_process.enabled;
+    }
 
-                if(GlobalState.player.game_over) {
-                    stateMachineSet(STATE_GAMEOVER);
-                }
+    // Switching the low-latency mode (the latency percentiles start over, so they're measuring only the new mode)
+    if(IsKeyPressed(KEY_F7)) {
+        GlobalState.Game.low_latency = !GlobalState.Game.low_latency;
+        inputSetLowLatency(GlobalState.Game.low_latency);
+        inputQueueResetLatency(&GlobalState.Game.input_queue);
+    }
 
-                GlobalState.Resources.music_background_volume = Lerp(GlobalState.Resources.music_background_volume, MUSIC_VOLUME_GAMEPLAY, GetFrameTime());
+    // Dropping the tick rate when there's nothing to show or nothing is moving
+    frameSchedulerUpdate(&GlobalState.Game.frame_scheduler);
 
-            } break;
+    // Adjusting the internal resolution to the window size and the frame-time budget
+    // (The limited frames of the frame scheduler would look like an overload, so they're not measured)
+    // The post-processing passes are the first to go when we're over the budget, and the resolution is the first to come back
+    if(frameSchedulerIsFullRate(&GlobalState.Game.frame_scheduler)) {
+        bool resolution_full = GlobalState.Game.render_scaler.level == 0;
 
-            case STATE_GAMEOVER: {
-                if(GetKeyPressed() || IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsMouseButtonPressed(MOUSE_RIGHT_BUTTON) || GetTouchPointCount() > 0) {
-                    stateMachineSet(STATE_START);
-                    gameInit();
-                }
+        if(!postProcessUpdateBudget(&GlobalState.Game.post_process, resolution_full)) {
+            renderScalerUpdate(&GlobalState.Game.render_scaler);
+        }
+    }
 
-                GlobalState.Resources.music_background_volume = Lerp(GlobalState.Resources.music_background_volume, MUSIC_VOLUME_GAME_OVER, GetFrameTime());
+    renderUpdateSize();
 
-            } break;
+    // Window-scaling for render texture
+    // (For how it works check out the raylib's exaples: https://www.raylib.com/examples.html)
+    // The mouse is mapped to the world units, so it doesn't depend on the current internal resolution.
+    Rectangle viewport = renderGetViewport();
+    float scale = viewport.width / worldGetSize().x;
+    SetMouseOffset(-viewport.x, -viewport.y);
+    SetMouseScale(1 / scale, 1 / scale);
 
-            case STATE_PAUSE: {
-                if(IsKeyPressed(KEY_ESCAPE)) {
-                    stateMachineSet(STATE_RESUME);
-                }
+    TRACE_END();
+    
+    // (Long frames after the window gets restored could push the interpolated volume out of the range)
+    TRACE_BEGIN("UpdateMusicStream");
+    GlobalState.Resources.music_background_volume = Clamp(GlobalState.Resources.music_background_volume, MUSIC_VOLUME_MUTED, MUSIC_VOLUME_GAME_START);
+    SetMusicVolume(GlobalState.Resources.music_background, GlobalState.Resources.music_background_volume);
+    UpdateMusicStream(GlobalState.Resources.music_background);
+    TRACE_END();
 
-                GlobalState.Resources.music_background_volume = Lerp(GlobalState.Resources.music_background_volume, MUSIC_VOLUME_GAME_PAUSED, GetFrameTime());
+    // State-Dependent update loop...
+    TRACE_BEGIN("update");
 
-            } break;
+    switch (GlobalState.Game.gameplay_state_machine) {
+        case STATE_WELCOME_SCREEN: {
+            if(!resourcesIsLoaded()) {
+                resourcesUpdate();
 
-            case STATE_RESUME: {
-                GlobalState.Game.resume_countdown -= GetFrameTime();
-                
-                if((GlobalState.Game.resume_countdown <= 0.0f) || GetKeyPressed() || IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsMouseButtonPressed(MOUSE_RIGHT_BUTTON) || GetTouchPointCount() > 0) {
-                    GlobalState.Game.resume_countdown = GAME_RESUME_TIME;
-                    stateMachineSet(STATE_GAMEPLAY);
+                if(resourcesIsLoaded()) {
+                    gameInit();
                 }
-            } break;
-        }
+            }
 
-        BeginTextureMode(GlobalState.Game.render_texture);
-        ClearBackground(BLACK);
+            // The fade-out (the last second of the timer) waits until all the resources are ready
+            if(resourcesIsLoaded() || GlobalState.Game.welcome_screen_time > 1.0f) {
+                GlobalState.Game.welcome_screen_time -= GetFrameTime();
+                timerProceed(&GlobalState.Game.welcome_screen_timer);
+            }
 
-        // Render your graphics here...
+            if(resourcesIsLoaded() && (timerFinished(&GlobalState.Game.welcome_screen_timer) || GetKeyPressed())) {
+                stateMachineSet(STATE_START);
+            }
 
-        // State-Independent rendering...
-        BeginMode2D(GlobalState.camera);
+            GlobalState.Resources.music_background_volume = Lerp(GlobalState.Resources.music_background_volume, MUSIC_VOLUME_GAME_START, GetFrameTime());
 
-            backgroundRender(&GlobalState.background);
-            playerRender();
-            obstacleListRender();
-            debugRenderCollisions();
-        
-        EndMode2D();
-
-        debugRenderData();
-
-        // State-dependent rendering...
-        switch (GlobalState.Game.gameplay_state_machine) {
-            case STATE_WELCOME_SCREEN: {
-                const char* text0 = "Made with raylib!";
-                Vector2 text0_size = MeasureTextEx(GetFontDefault(), text0, TEXT_FONT_SIZE, TEXT_FONT_SPACING);
-
-                DrawRectangle(
-                    0, 
-                    0, 
-                    renderGetSize().x, 
-                    renderGetSize().y, 
-                    (Color) {
-                        245,
-                        245,
-                        245,
-                        timer_welcome_screen_time < 1.0f ? Lerp(0, 255, timer_welcome_screen_time) : 255
-                    }
-                );
+        } break;
 
-                DrawTexturePro(
-                    GlobalState.Resources.texture_raylib_logo, 
-                    (Rectangle) { 0, 0, GlobalState.Resources.texture_raylib_logo.width, GlobalState.Resources.texture_raylib_logo.height }, 
-                    (Rectangle) { renderGetSize().x / 2.0f, renderGetSize().y / 2.0f, GlobalState.Resources.texture_raylib_logo.width, GlobalState.Resources.texture_raylib_logo.height }, 
-                    (Vector2) { GlobalState.Resources.texture_raylib_logo.width / 2.0f, GlobalState.Resources.texture_raylib_logo.height / 2.0f }, 
-                    0.0f,
-                    (Color) {
-                        255,
-                        255,
-                        255,
-                        timer_welcome_screen_time < 1.0f ? Lerp(0, 255, timer_welcome_screen_time) : 255
-                    }
-                );
+        case STATE_START: {
 
-                DrawTextPro(
-                    GetFontDefault(), 
-                    text0, 
-                    (Vector2) { renderGetSize().x / 2.0f, renderGetSize().y / 2.0f + 256}, 
-                    Vector2Divide(text0_size, (Vector2) { 2.0f, 2.0f } ), 
-                    0.0f, 
-                    TEXT_FONT_SIZE, 
-                    TEXT_FONT_SPACING, 
-                    (Color) {
-                        0,
-                        0,
-                        0,
-                        timer_welcome_screen_time < 1.0f ? Lerp(0, 255, timer_welcome_screen_time) : 255
-                    }
-                );
+            if(playerInputGetPress()) {
+                gameStart();
+            }
 
+            if(IsKeyPressed(KEY_ESCAPE)) {
+                GlobalState.Game.quit = true;
+            }
 
-            } break;
+            GlobalState.Resources.music_background_volume = Lerp(GlobalState.Resources.music_background_volume, MUSIC_VOLUME_GAME_START, GetFrameTime());
 
-            case STATE_START: {
-                const char* text0 = GAME_TITLE;
-                const char* text1 = "Press SPACE or LBM to start";
+        } break;
 
-                Vector2 text0_size = MeasureTextEx(RESOURCES_FONT_LARGE, text0, TEXT_FONT_LARGE_SIZE, TEXT_FONT_SPACING);
-                Vector2 text1_size = MeasureTextEx(RESOURCES_FONT_DEFAULT, text1, TEXT_FONT_SIZE, TEXT_FONT_SPACING);
+        case STATE_GAMEPLAY: {
+            simulationUpdate();
 
-                DrawTextPro(
-                    RESOURCES_FONT_LARGE, 
-                    text0, 
-                    (Vector2) { renderGetSize().x / 2.0f, renderGetSize().y / 2.0f - 192}, 
-                    Vector2Divide(text0_size, (Vector2) { 2.0f, 2.0f } ), 
-                    0.0f, 
-                    TEXT_FONT_LARGE_SIZE, 
-                    TEXT_FONT_SPACING, 
-                    GetColor(TEXT_COLOR_DARK)
-                );
+            if(IsKeyPressed(KEY_ESCAPE)) {
+                stateMachineSet(STATE_PAUSE);
+            }
 
-                DrawTextPro(
-                    RESOURCES_FONT_DEFAULT, 
-                    text1, 
-                    (Vector2) { renderGetSize().x / 2.0f, renderGetSize().y / 2.0f + 128}, 
-                    Vector2Divide(text1_size, (Vector2) { 2.0f, 2.0f } ), 
-                    0.0f, 
-                    TEXT_FONT_SIZE, 
-                    TEXT_FONT_SPACING, 
-                    Fade(GetColor(TEXT_COLOR_DARK), 0.5f)
-                );
+            if(GlobalState.simulation.player.game_over) {
+                stateMachineSet(STATE_GAMEOVER);
+            }
 
-            } break;
-
-            case STATE_GAMEPLAY: {
-                playerRenderScore(
-                    (Vector2) { 
-                        8.0f, 
-                        renderGetSize().y - 240.0f 
-                    }, 
-                    (Vector2) { 
-                        32.0f, 
-                        16.0f 
-                    }
-                );
+            GlobalState.Resources.music_background_volume = Lerp(GlobalState.Resources.music_background_volume, MUSIC_VOLUME_GAMEPLAY, GetFrameTime());
 
-            } break;
+        } break;
 
-            case STATE_GAMEOVER: {
-                DrawRectangle(
-                    0,
-                    0,
-                    renderGetSize().x,
-                    renderGetSize().y,
-                    Fade(BLACK, 0.5f)
-                );
+        case STATE_GAMEOVER: {
+            // Rewinding out of the crash (the crashing tick is the newest record, so a single step is enough to get back into the game)
+            if(IsKeyDown(REWIND_KEY)) {
+                if(rewindStep(&GlobalState.rewind)) {
+                    simulationRestore(&GlobalState.rewind.last);
+                    stateMachineSet(STATE_GAMEPLAY);
+                }
+            } else if(GetKeyPressed() || playerInputGetPress() || IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsMouseButtonPressed(MOUSE_RIGHT_BUTTON) || GetTouchPointCount() > 0) {
+                stateMachineSet(STATE_START);
+                gameRestart();
+            }
 
-                const char* text0 = "Game Over!";
-                const char* text1 = TextFormat("> Total Time: %.02fs\n> Total Score: %i", GlobalState.Game.gameplay_time, GlobalState.player.points);
-                const char* text2 = "Press ANY KEY to RESTART...";
+            GlobalState.Resources.music_background_volume = Lerp(GlobalState.Resources.music_background_volume, MUSIC_VOLUME_GAME_OVER, GetFrameTime());
 
-                Vector2 text0_size = MeasureTextEx(RESOURCES_FONT_LARGE, text0, TEXT_FONT_LARGE_SIZE, TEXT_FONT_SPACING);
-                Vector2 text1_size = MeasureTextEx(RESOURCES_FONT_DEFAULT, text1, TEXT_FONT_SIZE, TEXT_FONT_SPACING);
-                Vector2 text2_size = MeasureTextEx(RESOURCES_FONT_DEFAULT, text2, TEXT_FONT_SIZE, TEXT_FONT_SPACING);
+        } break;
 
-                SetTextLineSpacing(TEXT_FONT_SIZE);
+        case STATE_PAUSE: {
+            if(IsKeyPressed(KEY_ESCAPE)) {
+                stateMachineSet(STATE_RESUME);
+            }
 
-                DrawTextPro(
-                    RESOURCES_FONT_LARGE, 
-                    text0, 
-                    (Vector2) { renderGetSize().x / 2.0f, renderGetSize().y / 2.0f}, 
-                    Vector2Divide(text0_size, (Vector2) { 2.0f, 2.0f } ), 
-                    0.0f, 
-                    TEXT_FONT_LARGE_SIZE, 
-                    TEXT_FONT_SPACING, 
-                    GetColor(TEXT_COLOR_LIGHT)
-                );
+            GlobalState.Resources.music_background_volume = Lerp(GlobalState.Resources.music_background_volume, MUSIC_VOLUME_GAME_PAUSED, GetFrameTime());
 
-                DrawTextPro(
-                    RESOURCES_FONT_DEFAULT, 
-                    text1, 
-                    (Vector2) { renderGetSize().x / 2.0f, renderGetSize().y / 2.0f + text1_size.y * 2.0}, 
-                    Vector2Divide(text1_size, (Vector2) { 2.0f, 2.0f } ), 
-                    0.0f, 
-                    TEXT_FONT_SIZE, 
-                    TEXT_FONT_SPACING, 
-                    Fade(GetColor(TEXT_COLOR_LIGHT), 0.8f)
-                );
+        } break;
 
-                DrawTextPro(
-                    RESOURCES_FONT_DEFAULT, 
-                    text2, 
-                    (Vector2) { renderGetSize().x / 2.0f, renderGetSize().y / 2.0f + 256.0f}, 
-                    Vector2Divide(text2_size, (Vector2) { 2.0f, 2.0f } ), 
-                    0.0f, 
-                    TEXT_FONT_SIZE, 
-                    TEXT_FONT_SPACING, 
-                    Fade(GetColor(TEXT_COLOR_LIGHT), 0.8f)
-                );
+        case STATE_RESUME: {
+            GlobalState.Game.resume_countdown -= GetFrameTime();
+            
+            if((GlobalState.Game.resume_countdown <= 0.0f) || GetKeyPressed() || IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsMouseButtonPressed(MOUSE_RIGHT_BUTTON) || GetTouchPointCount() > 0) {
+                GlobalState.Game.resume_countdown = GAME_RESUME_TIME;
+                stateMachineSet(STATE_GAMEPLAY);
+            }
+        } break;
+    }
 
-            } break;
+    TRACE_END();
 
-            case STATE_PAUSE: {
-                DrawRectangle(
-                    0,
-                    0,
-                    renderGetSize().x,
-                    renderGetSize().y,
-                    Fade(BLACK, 0.5f)
-                );
+    TRACE_BEGIN("render");
 
-                const char* text0 = "Paused!";
-                const char* text1 = "Press ESCAPE to resume...";
+    // The cull pass: every render layer, the post-processing and the overlay use its visible lists.
+    // (The lists live in the frame arena, so they're rebuilt every frame, even when the world is frozen)
+    TRACE_BEGIN("renderVisibilityBuild");
+    GlobalState.visibility = resourcesIsLoaded() ? 
+        renderVisibilityBuild(&GlobalState.frame_arena, renderGetWorldBounds()) : 
+        (RenderVisibility) { .bounds = renderGetWorldBounds() };
+    TRACE_END();
 
-                Vector2 text0_size = MeasureTextEx(RESOURCES_FONT_LARGE, text0, TEXT_FONT_LARGE_SIZE, TEXT_FONT_SPACING);
-                Vector2 text1_size = MeasureTextEx(RESOURCES_FONT_DEFAULT, text1, TEXT_FONT_SIZE, TEXT_FONT_SPACING);
+    // The world doesn't move on the paused and game-over screens, so it's rendered only once into the freeze frame
+    if(stateMachineIsFrozen()) {
+        renderUpdateFreezeFrame();
+    }
 
-                DrawTextPro(
-                    RESOURCES_FONT_LARGE, 
-                    text0, 
-                    (Vector2) { renderGetSize().x / 2.0f, renderGetSize().y / 2.0f}, 
-                    Vector2Divide(text0_size, (Vector2) { 2.0f, 2.0f } ), 
-                    0.0f, 
-                    TEXT_FONT_LARGE_SIZE, 
-                    TEXT_FONT_SPACING, 
-                    GetColor(TEXT_COLOR_LIGHT)
-                );
+    // The overdraw heat-map replaces the world (and it's re-rendered every frame, even when the world is frozen)
+    if(GlobalState.Debug.render_overdraw) {
+        TRACE_BEGIN("overdrawViewUpdate");
+        overdrawViewUpdate(&GlobalState.Debug.overdraw_view);
+        TRACE_END();
+    }
 
-                DrawTextPro(
-                    RESOURCES_FONT_DEFAULT, 
-                    text1, 
-                    (Vector2) { renderGetSize().x / 2.0f, renderGetSize().y / 2.0f + 128}, 
-                    Vector2Divide(text1_size, (Vector2) { 2.0f, 2.0f } ), 
-                    0.0f, 
-                    TEXT_FONT_SIZE, 
-                    TEXT_FONT_SPACING, 
-                    Fade(GetColor(TEXT_COLOR_LIGHT), 0.8f)
-                );    
-
-            } break;
-
-            case STATE_RESUME: {
-                DrawRectangle(
+    BeginTextureMode(GlobalState.Game.render_texture);
+    ClearBackground(BLACK);
+
+    // Render your graphics here...
+
+    // State-Independent rendering...
+    if(GlobalState.Debug.render_overdraw) {
+        overdrawViewRender(&GlobalState.Debug.overdraw_view);
+    } else if(stateMachineIsFrozen()) {
+        renderFreezeFrame();
+    } else {
+        renderWorld();
+    }
+
+    EndTextureMode();
+
+    // The post-processing is applied to the world only (the HUD is drawn into its output afterwards).
+    // (There's no world before the resources are loaded, and the overdraw view must stay as it is)
+    RenderTexture2D* frame = &GlobalState.Game.render_texture;
+
+    if(resourcesIsLoaded() && !GlobalState.Debug.render_overdraw) {
+        TRACE_BEGIN("postProcessApply");
+        frame = postProcessApply(&GlobalState.Game.post_process, frame);
+        TRACE_END();
+    }
+
+    TRACE_BEGIN("hud");
+    BeginTextureMode(*frame);
+
+    // HUD and overlays are using the world units as well (the screen camera only scales them to the internal resolution)
+    BeginMode2D(renderGetScreenCamera());
+
+    debugRenderData();
+
+    // State-dependent rendering...
+    switch (GlobalState.Game.gameplay_state_machine) {
+        case STATE_WELCOME_SCREEN: {
+            const char* text0 = "Made with raylib!";
+            const float text0_font_size = 32.0f; // The game fonts might not be loaded yet
+            Vector2 text0_size = MeasureTextEx(GetFontDefault(), text0, text0_font_size, TEXT_FONT_SPACING);
+
+            DrawRectangle(
+                0, 
+                0, 
+                worldGetSize().x, 
+                worldGetSize().y, 
+                (Color) {
+                    245,
+                    245,
+                    245,
+                    GlobalState.Game.welcome_screen_time < 1.0f ? Lerp(0, 255, GlobalState.Game.welcome_screen_time) : 255
+                }
+            );
+
+            DrawTexturePro(
+                GlobalState.Resources.texture_raylib_logo, 
+                (Rectangle) { 0, 0, GlobalState.Resources.texture_raylib_logo.width, GlobalState.Resources.texture_raylib_logo.height }, 
+                (Rectangle) { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f, GlobalState.Resources.texture_raylib_logo.width, GlobalState.Resources.texture_raylib_logo.height }, 
+                (Vector2) { GlobalState.Resources.texture_raylib_logo.width / 2.0f, GlobalState.Resources.texture_raylib_logo.height / 2.0f }, 
+                0.0f,
+                (Color) {
+                    255,
+                    255,
+                    255,
+                    GlobalState.Game.welcome_screen_time < 1.0f ? Lerp(0, 255, GlobalState.Game.welcome_screen_time) : 255
+                }
+            );
+
+            DrawTextPro(
+                GetFontDefault(), 
+                text0, 
+                (Vector2) { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f + 256}, 
+                Vector2Divide(text0_size, (Vector2) { 2.0f, 2.0f } ), 
+                0.0f, 
+                text0_font_size, 
+                TEXT_FONT_SPACING, 
+                (Color) {
                     0,
                     0,
-                    renderGetSize().x,
-                    renderGetSize().y,
-                    Fade(BLACK, 0.5f)
-                );
+                    0,
+                    GlobalState.Game.welcome_screen_time < 1.0f ? Lerp(0, 255, GlobalState.Game.welcome_screen_time) : 255
+                }
+            );
 
-                const char* text0 = TextFormat("%.1f", GlobalState.Game.resume_countdown);
+            // Loading progress bar
+            if(!resourcesIsLoaded()) {
+                Rectangle progress_bar = { 
+                    worldGetSize().x / 2.0f - 128.0f, 
+                    worldGetSize().y / 2.0f + 192.0f, 
+                    256.0f, 
+                    8.0f 
+                };
+
+                DrawRectangleRec(progress_bar, Fade(BLACK, 0.1f));
+                DrawRectangleRec((Rectangle) { progress_bar.x, progress_bar.y, progress_bar.width * resourcesGetProgress(), progress_bar.height }, Fade(BLACK, 0.6f));
+            }
 
-                Vector2 text0_size = MeasureTextEx(RESOURCES_FONT_LARGE, text0, TEXT_FONT_LARGE_SIZE, TEXT_FONT_SPACING);
+        } break;
 
-                    DrawTextPro(
-                    RESOURCES_FONT_LARGE, 
-                    text0, 
-                    (Vector2) { renderGetSize().x / 2.0f, renderGetSize().y / 2.0f}, 
-                    Vector2Divide(text0_size, (Vector2) { 2.0f, 2.0f } ), 
-                    0.0f, 
-                    TEXT_FONT_LARGE_SIZE, 
-                    TEXT_FONT_SPACING, 
-                    GetColor(TEXT_COLOR_LIGHT)
-                );
+        case STATE_START: {
+            const char* text0 = GAME_TITLE;
+            const char* text1 = "Press SPACE or LBM to start";
 
-            } break;
-        }
-        
-        EndTextureMode();
+            Vector2 text0_size = MeasureTextEx(RESOURCES_FONT_LARGE, text0, TEXT_FONT_LARGE_SIZE, TEXT_FONT_SPACING);
+            Vector2 text1_size = MeasureTextEx(RESOURCES_FONT_DEFAULT, text1, TEXT_FONT_SIZE, TEXT_FONT_SPACING);
+
+            DrawTextPro(
+                RESOURCES_FONT_LARGE, 
+                text0, 
+                (Vector2) { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f - 192}, 
+                Vector2Divide(text0_size, (Vector2) { 2.0f, 2.0f } ), 
+                0.0f, 
+                TEXT_FONT_LARGE_SIZE, 
+                TEXT_FONT_SPACING, 
+                GetColor(TEXT_COLOR_DARK)
+            );
 
-        BeginDrawing();
+            DrawTextPro(
+                RESOURCES_FONT_DEFAULT, 
+                text1, 
+                (Vector2) { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f + 128}, 
+                Vector2Divide(text1_size, (Vector2) { 2.0f, 2.0f } ), 
+                0.0f, 
+                TEXT_FONT_SIZE, 
+                TEXT_FONT_SPACING, 
+                Fade(GetColor(TEXT_COLOR_DARK), 0.5f)
+            );
 
-            ClearBackground(BLACK);
+        } break;
 
-            DrawTexturePro(
-                GlobalState.Game.render_texture.texture, 
-                (Rectangle){
-                    0.0f,
-                    0.0f,
-                    GlobalState.Game.render_texture.texture.width,
-                    GlobalState.Game.render_texture.texture.height * -1.0f,
-                }, 
-                (Rectangle) { 
-                    (GetScreenWidth() - (GlobalState.Game.render_texture.texture.width * scale)) * 0.5f, 
-                    (GetScreenHeight() - (GlobalState.Game.render_texture.texture.height * scale)) * 0.5f,
-                    GlobalState.Game.render_texture.texture.width * scale,
-                    GlobalState.Game.render_texture.texture.height * scale,
+        case STATE_GAMEPLAY: {
+            playerRenderScore(
+                (Vector2) { 
+                    8.0f, 
+                    worldGetSize().y - 240.0f 
                 }, 
-                Vector2Zero(), 
+                (Vector2) { 
+                    32.0f, 
+                    16.0f 
+                }
+            );
+
+        } break;
+
+        case STATE_GAMEOVER: {
+            DrawRectangle(
+                0,
+                0,
+                worldGetSize().x,
+                worldGetSize().y,
+                Fade(BLACK, 0.5f)
+            );
+
+            const char* text0 = "Game Over!";
+            const char* text1 = frameArenaFormat(&GlobalState.frame_arena, "> Total Time: %.02fs\n> Total Score: %i", simulationGetTime(&GlobalState.simulation), GlobalState.simulation.player.points);
+            const char* text2 = "Press ANY KEY to RESTART...";
+
+            Vector2 text0_size = MeasureTextEx(RESOURCES_FONT_LARGE, text0, TEXT_FONT_LARGE_SIZE, TEXT_FONT_SPACING);
+            Vector2 text1_size = MeasureTextEx(RESOURCES_FONT_DEFAULT, text1, TEXT_FONT_SIZE, TEXT_FONT_SPACING);
+            Vector2 text2_size = MeasureTextEx(RESOURCES_FONT_DEFAULT, text2, TEXT_FONT_SIZE, TEXT_FONT_SPACING);
+
+            SetTextLineSpacing(TEXT_FONT_SIZE);
+
+            DrawTextPro(
+                RESOURCES_FONT_LARGE, 
+                text0, 
+                (Vector2) { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f}, 
+                Vector2Divide(text0_size, (Vector2) { 2.0f, 2.0f } ), 
+                0.0f, 
+                TEXT_FONT_LARGE_SIZE, 
+                TEXT_FONT_SPACING, 
+                GetColor(TEXT_COLOR_LIGHT)
+            );
+
+            DrawTextPro(
+                RESOURCES_FONT_DEFAULT, 
+                text1, 
+                (Vector2) { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f + text1_size.y * 2.0}, 
+                Vector2Divide(text1_size, (Vector2) { 2.0f, 2.0f } ), 
                 0.0f, 
-                WHITE
+                TEXT_FONT_SIZE, 
+                TEXT_FONT_SPACING, 
+                Fade(GetColor(TEXT_COLOR_LIGHT), 0.8f)
             );
 
-        EndDrawing();
+            DrawTextPro(
+                RESOURCES_FONT_DEFAULT, 
+                text2, 
+                (Vector2) { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f + 256.0f}, 
+                Vector2Divide(text2_size, (Vector2) { 2.0f, 2.0f } ), 
+                0.0f, 
+                TEXT_FONT_SIZE, 
+                TEXT_FONT_SPACING, 
+                Fade(GetColor(TEXT_COLOR_LIGHT), 0.8f)
+            );
+
+        } break;
+
+        case STATE_PAUSE: {
+            DrawRectangle(
+                0,
+                0,
+                worldGetSize().x,
+                worldGetSize().y,
+                Fade(BLACK, 0.5f)
+            );
+
+            const char* text0 = "Paused!";
+            const char* text1 = "Press ESCAPE to resume...";
+
+            Vector2 text0_size = MeasureTextEx(RESOURCES_FONT_LARGE, text0, TEXT_FONT_LARGE_SIZE, TEXT_FONT_SPACING);
+            Vector2 text1_size = MeasureTextEx(RESOURCES_FONT_DEFAULT, text1, TEXT_FONT_SIZE, TEXT_FONT_SPACING);
+
+            DrawTextPro(
+                RESOURCES_FONT_LARGE, 
+                text0, 
+                (Vector2) { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f}, 
+                Vector2Divide(text0_size, (Vector2) { 2.0f, 2.0f } ), 
+                0.0f, 
+                TEXT_FONT_LARGE_SIZE, 
+                TEXT_FONT_SPACING, 
+                GetColor(TEXT_COLOR_LIGHT)
+            );
+
+            DrawTextPro(
+                RESOURCES_FONT_DEFAULT, 
+                text1, 
+                (Vector2) { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f + 128}, 
+                Vector2Divide(text1_size, (Vector2) { 2.0f, 2.0f } ), 
+                0.0f, 
+                TEXT_FONT_SIZE, 
+                TEXT_FONT_SPACING, 
+                Fade(GetColor(TEXT_COLOR_LIGHT), 0.8f)
+            );    
+
+        } break;
+
+        case STATE_RESUME: {
+            DrawRectangle(
+                0,
+                0,
+                worldGetSize().x,
+                worldGetSize().y,
+                Fade(BLACK, 0.5f)
+            );
+
+            const char* text0 = frameArenaFormat(&GlobalState.frame_arena, "%.1f", GlobalState.Game.resume_countdown);
+
+            Vector2 text0_size = MeasureTextEx(RESOURCES_FONT_LARGE, text0, TEXT_FONT_LARGE_SIZE, TEXT_FONT_SPACING);
+
+                DrawTextPro(
+                RESOURCES_FONT_LARGE, 
+                text0, 
+                (Vector2) { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f}, 
+                Vector2Divide(text0_size, (Vector2) { 2.0f, 2.0f } ), 
+                0.0f, 
+                TEXT_FONT_LARGE_SIZE, 
+                TEXT_FONT_SPACING, 
+                GetColor(TEXT_COLOR_LIGHT)
+            );
+
+        } break;
     }
 
+    EndMode2D();
+    
+    EndTextureMode();
+    TRACE_END();
+
+    BeginDrawing();
+
+        ClearBackground(BLACK);
+
+        TRACE_BEGIN("antiAliasingRender");
+        antiAliasingRender(&GlobalState.Game.anti_aliasing, frame->texture, viewport);
+        TRACE_END();
+
+    TRACE_END();
+
+    // (The buffer swap, the frame limiter and the input polling)
+    // Without the V-Sync the swap doesn't wait, so the frame is presented right when it's submitted;
+    // with the V-Sync the swap blocks until the buffer is taken (the limiter isn't used, so that's when the 'EndDrawing' returns).
+    double submit_time = GetTime();
+
+    TRACE_BEGIN("EndDrawing");
+    EndDrawing();
+    TRACE_END();
+
+    inputQueuePresent(&GlobalState.Game.input_queue, GlobalState.Game.low_latency ? submit_time : GetTime());
+
+    TRACE_END();
+}
+
+void gameClose() {
     // Unloading resources...
+    jobSystemShutdown(&GlobalState.job_system);
+
+    // (The workers are joined, so nobody's writing into the trace buffers anymore)
+    traceWrite();
     resourcesUnload();
+    corridorRendererUnload(&GlobalState.corridor_renderer);
+    overdrawViewUnload(&GlobalState.Debug.overdraw_view);
+    antiAliasingUnload(&GlobalState.Game.anti_aliasing);
+    postProcessUnload(&GlobalState.Game.post_process);
+    frameArenaUnload(&GlobalState.frame_arena);
+    rewindUnload(&GlobalState.rewind);
     UnloadRenderTexture(GlobalState.Game.render_texture);
 
+    if(GlobalState.Game.freeze_frame.id > 0) {
+        UnloadRenderTexture(GlobalState.Game.freeze_frame);
+    }
+
     CloseAudioDevice();
     CloseWindow();
-
-    return 0;
 }
 
 void gameInit() {
-    GlobalState.player = playerInit(
+    // The simulation is built only once; every game (the first one included) starts from the copy of it (check the 'gameRestart')
+    SimulationState* initial = &GlobalState.simulation_initial;
+
+    *initial = (SimulationState) { 0 };
+
+    initial->player = playerInit(
         (Vector2) { 
-            renderGetSize().x / 2.0f - 256.0f, 
-            renderGetSize().y / 2.0f 
+            worldGetSize().x / 2.0f - 256.0f, 
+            worldGetSize().y / 2.0f 
         }
     );
 
-    GlobalState.camera = (Camera2D) {
-        .offset = { renderGetSize().x / 2.0f, renderGetSize().y / 2.0f },
-        .target = { renderGetSize().x / 2.0f, renderGetSize().y / 2.0f},
+    initial->camera = (Camera2D) {
+        .offset = { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f },
+        .target = { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f},
         .zoom = 1.0f
     };
 
-    GlobalState.player.particle_system = particleSystemInit(
-        &GlobalState.player.position, 
+    initial->player.particle_system = particleSystemInit(
+        initial->player.position, 
         0.05f,
         1.0f
     );
 
-    GlobalState.obstacle_list = obstacleListInit();
-
     GlobalState.background = backgroundInit();
 
     GlobalState.Debug.render_data = false;
     GlobalState.Debug.render_colliders = false;
+    GlobalState.Debug.render_overdraw = false;
 
-    GlobalState.Game.gameplay_time = 0.0f;
-    GlobalState.Game.resume_countdown = GAME_RESUME_TIME;
     GlobalState.Game.quit = false;
-    GlobalState.Game.start_key_held = true;
 
     PlayMusicStream(GlobalState.Resources.music_background);
+
+    gameRestart();
+}
+
+void gameRestart() {
+    // The restart is a single copy of the initial simulation state; only the obstacles are generated anew,
+    // so every game gets its own corridor (the music and everything else outside the simulation keeps going as it is)
+    GlobalState.simulation = GlobalState.simulation_initial;
+    GlobalState.simulation.obstacle_list = obstacleListInit(&GlobalState.simulation.entities);
+
+    rewindReset(&GlobalState.rewind, &GlobalState.simulation);
+
+    GlobalState.Game.resume_countdown = GAME_RESUME_TIME;
+    GlobalState.Game.start_key_held = true;
+}
+
+void gameStart() {
+    // The first push of the button
+    playerSetVelocity((Vector2) { 0.0f, -PLAYER_GRAVITY_Y * 16.0f / PLAYER_REFERENCE_FPS });
+    stateMachineSet(STATE_GAMEPLAY);
+}
+
+void simulationRestore(SimulationState* state) {
+    GlobalState.simulation = *state;
+
+    // The obstacles the stream has generated ahead don't have to continue the restored list, so it starts over from its last obstacle
+    ObstacleList* obstacle_list = &GlobalState.simulation.obstacle_list;
+    obstacleStreamReset(&GlobalState.obstacle_stream, &obstacle_list->list[OBSTACLE_CAPACITY - 1], obstacle_list->random, obstacle_list->generated_count);
+
+    GlobalState.Game.freeze_frame_valid = false;
+}
+
+double simulationGetTime(SimulationState* state) {
+    return (double) state->gameplay_ticks * SIMULATION_STEP;
+}
+
+void simulationUpdate() {
+    JobSystem* job_system = &GlobalState.job_system;
+    InputQueue* input_queue = &GlobalState.Game.input_queue;
+
+    JobCounter simulation_counter = { 0 };
+
+    // Fixed-step ticks from the accumulated frame time, each with its slice of the input events (or backwards, while rewinding)
+    TRACE_BEGIN("rewindUpdate");
+    bool rewinding = rewindUpdate(&GlobalState.rewind);
+    TRACE_END();
+
+    if(!rewinding) {
+        GlobalState.simulation.accumulator += GlobalState.autopilot.frame_time > 0.0f ? GlobalState.autopilot.frame_time : GetFrameTime();
+
+        for(int tick = 0; GlobalState.simulation.accumulator >= SIMULATION_STEP; tick++) {
+            if(tick == SIMULATION_TICKS_MAX || GlobalState.simulation.player.game_over) {
+                GlobalState.simulation.accumulator = 0.0f;
+                break;
+            }
+
+            GlobalState.simulation.accumulator -= SIMULATION_STEP;
+
+            double tick_end = input_queue->poll_time - GlobalState.simulation.accumulator;
+            float held_time = inputQueueConsume(input_queue, tick_end - SIMULATION_STEP, tick_end);
+
+            TRACE_BEGIN("simulationTick");
+            simulationTick(held_time);
+            TRACE_END();
+        }
+    }
+
+    // The visual-only work is done once per frame, on the job system (the ticks above are done, so the player stays where it is)...
+    jobSystemSubmit(job_system, particleSystemUpdateJob, &GlobalState.simulation.player.particle_system, &simulation_counter);
+    jobSystemSubmit(job_system, backgroundUpdateJob, &GlobalState.background, &simulation_counter);
+
+    // ... and nothing leaves this function before all of it is done (the barrier in between the simulation and the rendering).
+    jobSystemWait(job_system, &simulation_counter);
+}
+
+void simulationTick(float held_time) {
+    playerUpdate(SIMULATION_STEP, held_time);
+
+    // The collisions need the obstacle list before it's looped (and they're playing sounds, so they're on the main thread).
+    // The pickups are looked up in the grid, so it's rebuilt right before them (the entities have moved since the last tick)
+    spatialGridBuild(&GlobalState.entity_grid, &GlobalState.simulation.entities);
+
+    TRACE_BEGIN("playerCheckCollisions");
+    playerCheckCollisions();
+    TRACE_END();
+
+    TRACE_BEGIN("obstacleListLoopObstacles");
+    obstacleListLoopObstacles();
+    TRACE_END();
+
+    entityStoreUpdate(&GlobalState.simulation.entities, SIMULATION_STEP);
+
+    GlobalState.simulation.camera.target.x += floatingOriginSnap(PLAYER_SPEED * SIMULATION_STEP);
+    GlobalState.simulation.gameplay_ticks++;
+
+    floatingOriginUpdate();
+
+    // Every tick can be rewound
+    rewindPush(&GlobalState.rewind, &GlobalState.simulation);
+}
+
+void floatingOriginUpdate() {
+    SimulationState* state = &GlobalState.simulation;
+
+    // Once the camera crosses the threshold, everything is shifted back by the whole passed obstacles (the shift is exact)
+    if(state->camera.target.x < FLOATING_ORIGIN_THRESHOLD || GlobalState.floating_origin_disabled) {
+        return;
+    }
+
+    float shift = floorf(state->obstacle_list.list[0].position.x / FLOATING_ORIGIN_STEP) * FLOATING_ORIGIN_STEP;
+
+    floatingOriginShift(state, shift);
+
+    // The obstacles the stream has generated ahead are still in the old coordinates, so it starts over from the shifted list
+    ObstacleList* obstacle_list = &state->obstacle_list;
+    obstacleStreamReset(&GlobalState.obstacle_stream, &obstacle_list->list[OBSTACLE_CAPACITY - 1], obstacle_list->random, obstacle_list->generated_count);
+}
+
+void floatingOriginShift(SimulationState* state, float shift) {
+    Player* player = &state->player;
+
+    state->origin_x += shift;
+    state->camera.target.x -= shift;
+
+    player->position.x -= shift;
+    player->position_prev.x -= shift;
+    player->particle_system.target.x -= shift;
+
+    for(int i = 0; i < PARTICLES_CAPACITY; i++) {
+        player->particle_system.particles[i].position.x -= shift;
+    }
+
+    for(int i = 0; i < OBSTACLE_CAPACITY; i++) {
+        Obstacle* obstacle = &state->obstacle_list.list[i];
+
+        obstacle->position.x -= shift;
+        obstacle->point0.x -= shift;
+        obstacle->point1.x -= shift;
+    }
+
+    entityStoreShift(&state->entities, shift);
+}
+
+float floatingOriginSnap(float x) {
+    // (Adding and subtracting 1.5 * 2^23 rounds to the whole number without a library call, so the loops over the entities still vectorize)
+    const float round = 12582912.0f;
+
+    return ((x * FLOATING_ORIGIN_GRID + round) - round) / FLOATING_ORIGIN_GRID;
 }
 
 void resourcesLoad() {
+    ResourceLoader* loader = &GlobalState.Resources.loader;
+
+    // raylib logo: https://github.com/raysan5/raylib/blob/master/logo/raylib_256x256.png
+    // (It's loaded right away, as the welcome screen needs it from the very first frame)
+    GlobalState.Resources.texture_raylib_logo = LoadTexture("../res/graphics/raylib_256x256.png");
+
     // background resource
-    GlobalState.Resources.texture_background = LoadTexture("../res/graphics/game_background.png");
+    resourcesRequestTexture(&GlobalState.Resources.texture_background, "../res/graphics/game_background.png", TEXTURE_FILTER_BILINEAR, TEXTURE_WRAP_REPEAT);
 
     // player resources
-    GlobalState.Resources.texture_player = LoadTexture("../res/graphics/player_sprite.png");
+    resourcesRequestTexture(&GlobalState.Resources.texture_player, "../res/graphics/player_sprite.png", TEXTURE_FILTER_BILINEAR, TEXTURE_WRAP_CLAMP);
 
     // collectible resources
-    GlobalState.Resources.texture_collectibles[0] = LoadTexture("../res/graphics/collectible_common.png");
-    GlobalState.Resources.texture_collectibles[1] = LoadTexture("../res/graphics/collectible_rare.png");
-    GlobalState.Resources.texture_collectibles[2] = LoadTexture("../res/graphics/collectible_legendary.png");
+    resourcesRequestTexture(&GlobalState.Resources.texture_collectibles[0], "../res/graphics/collectible_common.png", TEXTURE_FILTER_BILINEAR, TEXTURE_WRAP_CLAMP);
+    resourcesRequestTexture(&GlobalState.Resources.texture_collectibles[1], "../res/graphics/collectible_rare.png", TEXTURE_FILTER_BILINEAR, TEXTURE_WRAP_CLAMP);
+    resourcesRequestTexture(&GlobalState.Resources.texture_collectibles[2], "../res/graphics/collectible_legendary.png", TEXTURE_FILTER_BILINEAR, TEXTURE_WRAP_CLAMP);
 
     // particle resources
-    GlobalState.Resources.texture_particle_bubble = LoadTexture("../res/graphics/particle_bubble.png");
-
-    // raylib logo: https://github.com/raysan5/raylib/blob/master/logo/raylib_256x256.png
-    GlobalState.Resources.texture_raylib_logo = LoadTexture("../res/graphics/raylib_256x256.png");
+    resourcesRequestTexture(&GlobalState.Resources.texture_particle_bubble, "../res/graphics/particle_bubble.png", TEXTURE_FILTER_BILINEAR, TEXTURE_WRAP_CLAMP);
 
     // font resources
-    GlobalState.Resources.font_game_default = LoadFontEx(
-        "../res/fonts/Fredoka/static/Fredoka-Bold.ttf",
-        32,
-        0,
-        256
-    );  
-
-    GlobalState.Resources.font_game_large = LoadFontEx(
-        "../res/fonts/Fredoka/static/Fredoka-Bold.ttf",
-        96,
-        0,
-        256
-    );     
+    resourcesRequestFont(&GlobalState.Resources.font_game_default, "../res/fonts/Fredoka/static/Fredoka-Bold.ttf", 32);
+    resourcesRequestFont(&GlobalState.Resources.font_game_large, "../res/fonts/Fredoka/static/Fredoka-Bold.ttf", 96);
 
     // sound resources
-    GlobalState.Resources.sound_particle_bubble = LoadSound("../res/sfx/sfx_bubble.mp3");
-    GlobalState.Resources.sound_collectible_pickup = LoadSound("../res/sfx/sfx_collectible_3.wav");
+    resourcesRequestSound(&GlobalState.Resources.sound_particle_bubble, "../res/sfx/sfx_bubble.mp3");
+    resourcesRequestSound(&GlobalState.Resources.sound_collectible_pickup, "../res/sfx/sfx_collectible_3.wav");
     
     // Source: https://sonic.fandom.com/wiki/Aquarium_Park
+    // (Music is streamed, so opening it is cheap - it stays on the main thread together with the rest of the audio device calls)
     GlobalState.Resources.music_background = LoadMusicStream("../res/sfx/Aquarium_Park_Act_1.wav");
     GlobalState.Resources.music_background_volume = 0.0f;
 
-    // Setting up the filtering for the graphical res...
-    SetTextureFilter(GlobalState.Resources.texture_background, TEXTURE_FILTER_BILINEAR);
+    for(int i = 0; i < loader->request_count; i++) {
+        jobSystemSubmit(&GlobalState.job_system, resourcesDecodeJob, &loader->requests[i], &loader->counter);
+    }
+}
+
+void resourcesUpdate() {
+    ResourceLoader* loader = &GlobalState.Resources.loader;
+
+#if !defined(JOB_SYSTEM_THREADED)
+    // No worker threads - we're decoding one resource per frame, so the welcome screen is still responsive
+    jobSystemHelp(&GlobalState.job_system);
+#endif
+
+    // GPU and audio uploads have to happen on the main thread, as soon as the resource is decoded
+    for(int i = 0; i < loader->request_count; i++) {
+        ResourceRequest* request = &loader->requests[i];
+
+        if(request->uploaded || !atomic_load_explicit(&request->decoded, memory_order_acquire)) {
+            continue;
+        }
+
+        resourcesUploadRequest(request);
+
+        request->uploaded = true;
+        loader->uploaded_count++;
+    }
+}
+
+bool resourcesIsLoaded() {
+    return GlobalState.Resources.loader.uploaded_count >= GlobalState.Resources.loader.request_count;
+}
+
+float resourcesGetProgress() {
+    ResourceLoader* loader = &GlobalState.Resources.loader;
+
+    return loader->request_count > 0 ? (float) loader->uploaded_count / loader->request_count : 1.0f;
+}
+
+void resourcesRequestTexture(Texture2D* target, const char* path, int filter, int wrap) {
+    ResourceLoader* loader = &GlobalState.Resources.loader;
 
-    SetTextureFilter(GlobalState.Resources.texture_player, TEXTURE_FILTER_BILINEAR);
+    if(loader->request_count >= RESOURCES_REQUEST_CAPACITY) {
+        TraceLog(LOG_WARNING, "RESOURCES: Request capacity exceeded, loading %s synchronously", path);
+        *target = LoadTexture(path);
+        return;
+    }
+
+    loader->requests[loader->request_count++] = (ResourceRequest) {
+        .type = RESOURCE_TYPE_TEXTURE,
+        .path = path,
+        .target = target,
+        .texture_filter = filter,
+        .texture_wrap = wrap
+    };
+}
+
+void resourcesRequestFont(Font* target, const char* path, int font_size) {
+    ResourceLoader* loader = &GlobalState.Resources.loader;
+
+    if(loader->request_count >= RESOURCES_REQUEST_CAPACITY) {
+        TraceLog(LOG_WARNING, "RESOURCES: Request capacity exceeded, loading %s synchronously", path);
+        *target = LoadFontEx(path, font_size, 0, RESOURCES_FONT_GLYPH_COUNT);
+        return;
+    }
+
+    loader->requests[loader->request_count++] = (ResourceRequest) {
+        .type = RESOURCE_TYPE_FONT,
+        .path = path,
+        .target = target,
+        .texture_filter = TEXTURE_FILTER_BILINEAR,
+        .texture_wrap = TEXTURE_WRAP_CLAMP,
+        .font_size = font_size
+    };
+}
+
+void resourcesRequestSound(Sound* target, const char* path) {
+    ResourceLoader* loader = &GlobalState.Resources.loader;
+
+    if(loader->request_count >= RESOURCES_REQUEST_CAPACITY) {
+        TraceLog(LOG_WARNING, "RESOURCES: Request capacity exceeded, loading %s synchronously", path);
+        *target = LoadSound(path);
+        return;
+    }
+
+    loader->requests[loader->request_count++] = (ResourceRequest) {
+        .type = RESOURCE_TYPE_SOUND,
+        .path = path,
+        .target = target
+    };
+}
+
+void resourcesDecodeJob(void* data) {
+    // This function runs on the worker thread, so it must only touch the CPU-side raylib functions (no GPU, no audio device)
+    ResourceRequest* request = (ResourceRequest*) data;
+
+    switch (request->type) {
+        case RESOURCE_TYPE_TEXTURE: {
+            request->image = LoadImage(request->path);
+        } break;
+
+        case RESOURCE_TYPE_FONT: {
+            // This is what the 'LoadFontEx' does, minus the texture upload
+            int file_size = 0;
+            unsigned char* file_data = LoadFileData(request->path, &file_size);
+
+            if(!file_data) {
+                break;
+            }
+
+            request->glyphs = LoadFontData(file_data, file_size, request->font_size, 0, RESOURCES_FONT_GLYPH_COUNT, FONT_DEFAULT);
+
+            if(request->glyphs) {
+                request->image = GenImageFontAtlas(request->glyphs, &request->glyph_recs, RESOURCES_FONT_GLYPH_COUNT, request->font_size, RESOURCES_FONT_GLYPH_PADDING, 0);
+
+                for(int i = 0; i < RESOURCES_FONT_GLYPH_COUNT; i++) {
+                    UnloadImage(request->glyphs[i].image);
+                    request->glyphs[i].image = ImageFromImage(request->image, request->glyph_recs[i]);
+                }
+            }
+
+            UnloadFileData(file_data);
+        } break;
+
+        case RESOURCE_TYPE_SOUND: {
+            request->wave = LoadWave(request->path);
+        } break;
+    }
 
-    SetTextureFilter(GlobalState.Resources.texture_collectibles[0], TEXTURE_FILTER_BILINEAR);
-    SetTextureFilter(GlobalState.Resources.texture_collectibles[1], TEXTURE_FILTER_BILINEAR);
-    SetTextureFilter(GlobalState.Resources.texture_collectibles[2], TEXTURE_FILTER_BILINEAR);
+    atomic_store_explicit(&request->decoded, true, memory_order_release);
+}
+
+void resourcesUploadRequest(ResourceRequest* request) {
+    switch (request->type) {
+        case RESOURCE_TYPE_TEXTURE: {
+            Texture2D* texture = (Texture2D*) request->target;
+
+            *texture = LoadTextureFromImage(request->image);
+            SetTextureFilter(*texture, request->texture_filter);
+            SetTextureWrap(*texture, request->texture_wrap);
+
+            UnloadImage(request->image);
+        } break;
+
+        case RESOURCE_TYPE_FONT: {
+            Font* font = (Font*) request->target;
+
+            // If the font couldn't be decoded, we're falling back to the raylib's default font (the same way 'LoadFontEx' does)
+            if(!request->glyphs) {
+                *font = GetFontDefault();
+                break;
+            }
+
+            *font = (Font) {
+                .baseSize = request->font_size,
+                .glyphCount = RESOURCES_FONT_GLYPH_COUNT,
+                .glyphPadding = RESOURCES_FONT_GLYPH_PADDING,
+                .texture = LoadTextureFromImage(request->image),
+                .recs = request->glyph_recs,
+                .glyphs = request->glyphs
+            };
 
-    SetTextureFilter(GlobalState.Resources.texture_particle_bubble, TEXTURE_FILTER_BILINEAR);
+            SetTextureFilter(font->texture, request->texture_filter);
 
-    SetTextureFilter(GlobalState.Resources.font_game_default.texture, TEXTURE_FILTER_BILINEAR);
-    SetTextureFilter(GlobalState.Resources.font_game_large.texture, TEXTURE_FILTER_BILINEAR);
+            UnloadImage(request->image);
+        } break;
+
+        case RESOURCE_TYPE_SOUND: {
+            Sound* sound = (Sound*) request->target;
+
+            *sound = LoadSoundFromWave(request->wave);
+
+            UnloadWave(request->wave);
+        } break;
+    }
+
+    request->image = (Image) { 0 };
+    request->wave = (Wave) { 0 };
 }
 
 void resourcesUnload() {
@@ -816,39 +2100,154 @@ void timerReset(Timer* timer, float time) {
     *timer = timerInit(time);
 }
 
-const char* stateMachineGetName() {
-    switch (GlobalState.Game.gameplay_state_machine) {
-        case STATE_WELCOME_SCREEN:      return "STATE_WELCOME_SCREEN";
-        case STATE_START:               return "STATE_START";
-        case STATE_GAMEPLAY:            return "STATE_GAMEPLAY";
-        case STATE_GAMEOVER:            return "STATE_GAMEOVER";
-        case STATE_PAUSE:               return "STATE_PAUSE";
-        case STATE_RESUME:              return "STATE_RESUME";
-    }
+Random randomInit(uint32_t seed) {
+    // (xorshift can't leave the zero state)
+    return (Random) {
+        .state = seed != 0 ? seed : 0x9e3779b9
+    };
 }
 
-void stateMachineSet(GameplayStateMachine state_machine) {
-    GlobalState.Game.gameplay_state_machine = state_machine;
-}
+uint32_t randomNext(Random* random) {
+    // Source: https://en.wikipedia.org/wiki/Xorshift
+    uint32_t x = random->state;
 
-Particle particleInit(Vector2 position, Vector2 velocity) {
-    return (Particle) {
-        .position = position,
-        .velocity = velocity,
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
 
-        .created = true
-    };
+    return random->state = x;
 }
 
-ParticleSystem particleSystemInit(Vector2* target, float spawn_time, float velocity_force) {
+int randomGetValue(Random* random, int min, int max) {
+    // Same contract as the 'GetRandomValue': both 'min' and 'max' are included
+    if(min > max) {
+        int tmp = max;
+        max = min;
+        min = tmp;
+    }
+
+    return min + (int) (randomNext(random) % ((uint32_t) (max - min) + 1));
+}
+
+SplineBasis splineBasisInit() {
+    SplineBasis result = { 0 };
+
+    for(int i = 0; i <= SPLINE_SEGMENT_RESOLUTION; i++) {
+        float t = i / (float) SPLINE_SEGMENT_RESOLUTION;
+        float u = 1.0f - t;
+
+        result.weights[i][0] = u * u * u;
+        result.weights[i][1] = 3.0f * t * u * u;
+        result.weights[i][2] = 3.0f * t * t * u;
+        result.weights[i][3] = t * t * t;
+    }
+
+    return result;
+}
+
+void splineEvaluateBasis(SplineBasis* basis, Vector2 p1, Vector2 c2, Vector2 c3, Vector2 p4, Vector2* samples) {
+    // The control points are relative to the 'p1' (the weights sum up to 1.0, so the 'p1' term drops out).
+    // It saves one multiplication, and the precision doesn't depend on how far the segment is from the origin.
+    Vector2 r2 = Vector2Subtract(c2, p1);
+    Vector2 r3 = Vector2Subtract(c3, p1);
+    Vector2 r4 = Vector2Subtract(p4, p1);
+
+    // Every sample is independent of the others, so the compiler is free to vectorize this loop
+    for(int i = 0; i <= SPLINE_SEGMENT_RESOLUTION; i++) {
+        const float* w = basis->weights[i];
+
+        samples[i].x = p1.x + w[1] * r2.x + w[2] * r3.x + w[3] * r4.x;
+        samples[i].y = p1.y + w[1] * r2.y + w[2] * r3.y + w[3] * r4.y;
+    }
+}
+
+void splineEvaluateForward(Vector2 p1, Vector2 c2, Vector2 c3, Vector2 p4, Vector2* samples) {
+    // Forward differencing relative to the 'p1': three additions per coordinate per sample
+    const float h = 1.0f / SPLINE_SEGMENT_RESOLUTION;
+
+    Vector2 r2 = Vector2Subtract(c2, p1);
+    Vector2 r3 = Vector2Subtract(c3, p1);
+    Vector2 r4 = Vector2Subtract(p4, p1);
+
+    Vector2 a = { 3.0f * r2.x - 3.0f * r3.x + r4.x, 3.0f * r2.y - 3.0f * r3.y + r4.y };
+    Vector2 b = { -6.0f * r2.x + 3.0f * r3.x, -6.0f * r2.y + 3.0f * r3.y };
+    Vector2 c = { 3.0f * r2.x, 3.0f * r2.y };
+
+    Vector2 point = { 0.0f, 0.0f };
+    Vector2 delta1 = { a.x * h * h * h + b.x * h * h + c.x * h, a.y * h * h * h + b.y * h * h + c.y * h };
+    Vector2 delta2 = { 6.0f * a.x * h * h * h + 2.0f * b.x * h * h, 6.0f * a.y * h * h * h + 2.0f * b.y * h * h };
+    Vector2 delta3 = { 6.0f * a.x * h * h * h, 6.0f * a.y * h * h * h };
+
+    for(int i = 0; i < SPLINE_SEGMENT_RESOLUTION; i++) {
+        samples[i] = (Vector2) { p1.x + point.x, p1.y + point.y };
+
+        point.x += delta1.x;    point.y += delta1.y;
+        delta1.x += delta2.x;   delta1.y += delta2.y;
+        delta2.x += delta3.x;   delta2.y += delta3.y;
+    }
+
+    // The accumulated rounding error is the biggest at the end, so the last sample is snapped to the end point
+    samples[SPLINE_SEGMENT_RESOLUTION] = p4;
+}
+
+const char* stateMachineGetName() {
+    switch (GlobalState.Game.gameplay_state_machine) {
+        case STATE_WELCOME_SCREEN:      return "STATE_WELCOME_SCREEN";
+        case STATE_START:               return "STATE_START";
+        case STATE_GAMEPLAY:            return "STATE_GAMEPLAY";
+        case STATE_GAMEOVER:            return "STATE_GAMEOVER";
+        case STATE_PAUSE:               return "STATE_PAUSE";
+        case STATE_RESUME:              return "STATE_RESUME";
+    }
+}
+
+void stateMachineSet(GameplayStateMachine state_machine) {
+    GlobalState.Game.gameplay_state_machine = state_machine;
+
+    // Every time we're leaving the frozen states, the next freeze needs a fresh capture of the world
+    if(!stateMachineIsFrozen()) {
+        GlobalState.Game.freeze_frame_valid = false;
+    }
+}
+
+bool stateMachineIsStatic() {
+    switch (GlobalState.Game.gameplay_state_machine) {
+        case STATE_START:
+        case STATE_PAUSE:
+        case STATE_GAMEOVER:            return true;
+        default:                        return false;
+    }
+}
+
+bool stateMachineIsFrozen() {
+    switch (GlobalState.Game.gameplay_state_machine) {
+        case STATE_PAUSE:
+        case STATE_RESUME:
+        case STATE_GAMEOVER:            return true;
+        default:                        return false;
+    }
+}
+
+Particle particleInit(Vector2 position, Vector2 velocity) {
+    return (Particle) {
+        .position = position,
+        .velocity = velocity,
+
+        .created = true
+    };
+}
+
+ParticleSystem particleSystemInit(Vector2 target, float spawn_time, float velocity_force) {
     return (ParticleSystem) {
         .current_particle_index = 0,
 
-        .particle_system_target = target,
+        .target = target,
 
         .initial_particle_velocity_force = velocity_force,
 
-        .spawn_timer = timerInit(spawn_time)
+        .spawn_timer = timerInit(spawn_time),
+
+        .random = randomInit(GetRandomValue(1, INT32_MAX))
     };
 }
 
@@ -861,10 +2260,10 @@ void particleSystemUpdate(ParticleSystem* particle_system) {
 
     if(timerFinished(&particle_system->spawn_timer)) {
         particle_system->particles[particle_system->current_particle_index] = particleInit(
-            *particle_system->particle_system_target, 
+            particle_system->target, 
             (Vector2) {
-                particle_system->initial_particle_velocity_force * cos(GetRandomValue(-360, 360)),
-                particle_system->initial_particle_velocity_force * sin(GetRandomValue(-360, 360))
+                particle_system->initial_particle_velocity_force * cos(randomGetValue(&particle_system->random, -360, 360)),
+                particle_system->initial_particle_velocity_force * sin(randomGetValue(&particle_system->random, -360, 360))
             }
         );
 
@@ -895,21 +2294,18 @@ void particleSystemUpdate(ParticleSystem* particle_system) {
     }
 }
 
-void particleSystemRender(ParticleSystem* particle_system) {
+void particleSystemUpdateJob(void* data) {
+    particleSystemUpdate((ParticleSystem*) data);
+}
+
+void particleSystemRender(ParticleSystem* particle_system, const int* visible, int visible_count) {
     if(!particle_system) {
         return;
     }
 
-    for(int i = 0; i < PARTICLES_CAPACITY; i++) {
-        int particle_index = 0;
-
-        particle_index = particle_system->current_particle_index - i < 0 ?
-            particle_system->current_particle_index - (particle_system->current_particle_index - i) :
-            i;
-
-        if(!particle_system->particles[particle_index].created) {
-            break;
-        }
+    // Only the particles that passed the culling (check the 'particleSystemCull')
+    for(int i = 0; i < visible_count; i++) {
+        int particle_index = visible[i];
 
         DrawTexturePro(
             GlobalState.Resources.texture_particle_bubble, 
@@ -932,6 +2328,34 @@ void particleSystemRender(ParticleSystem* particle_system) {
     }
 }
 
+int particleSystemCull(ParticleSystem* particle_system, Rectangle bounds, int* visible) {
+    int visible_count = 0;
+
+    if(!particle_system) {
+        return visible_count;
+    }
+
+    Vector2 particle_size = {
+        GlobalState.Resources.texture_particle_bubble.width,
+        GlobalState.Resources.texture_particle_bubble.height
+    };
+
+    for(int i = 0; i < PARTICLES_CAPACITY; i++) {
+        Particle* particle = &particle_system->particles[i];
+
+        if(!particle->created) {
+            break;
+        }
+
+        // (The bubbles are rising, so most of the old ones are already above the screen)
+        if(CheckCollisionRecs(bounds, (Rectangle) { particle->position.x, particle->position.y, particle_size.x, particle_size.y })) {
+            visible[visible_count++] = i;
+        }
+    }
+
+    return visible_count;
+}
+
 Player playerInit(Vector2 position) {
     Player result = {
         .position = position,
@@ -944,9 +2368,7 @@ Player playerInit(Vector2 position) {
         .sprite_rotation = 0.0f,
 
         .points = 0,
-        .collected_common = 0,
-        .collected_rare = 0,
-        .collected_legendary = 0,
+        .collected = { 0 },
         
         .game_over = false
     };
@@ -954,13 +2376,14 @@ Player playerInit(Vector2 position) {
     return result;
 }
 
-void playerUpdate() {
-    Player* player = &GlobalState.player;
+void playerUpdate(float step, float held_time) {
+    Player* player = &GlobalState.simulation.player;
 
     // Firstly, we apply our physics forces ..
+    // (The velocity is in world units per 'PLAYER_REFERENCE_FPS' frame, so the step of any length moves the player the same way)
     player->velocity = Vector2Add(
-        GlobalState.player.velocity, 
-        (Vector2) { PLAYER_GRAVITY_X * GetFrameTime(), PLAYER_GRAVITY_Y * GetFrameTime() }
+        GlobalState.simulation.player.velocity, 
+        (Vector2) { PLAYER_GRAVITY_X * step, PLAYER_GRAVITY_Y * step }
     );
 
     // ... (Don't forget to clamp it between the reasonabe bounds!) ...
@@ -971,30 +2394,34 @@ void playerUpdate() {
     );
 
     // ... Then we can menage the general gameplay stuff!
-    player->velocity.x = PLAYER_SPEED * GetFrameTime();
+    player->velocity.x = PLAYER_SPEED / PLAYER_REFERENCE_FPS;
 
     if((playerInputGetRelease()) && GlobalState.Game.start_key_held) {
         GlobalState.Game.start_key_held = false;
     }
 
-    if((playerInputGetDown()) && !GlobalState.Game.start_key_held) {
-        player->velocity.y -= PLAYER_GRAVITY_Y * 2.0f * GetFrameTime();
+    // The button pushes only for as long as it was held during this step (the events are timestamped, check the 'InputQueue')
+    if(!GlobalState.Game.start_key_held) {
+        player->velocity.y -= PLAYER_GRAVITY_Y * 2.0f * held_time;
     }
 
     // Lastly, we apply all the forces to our position.
-    playerIncrementPosition(player->velocity);
+    // (The player's particle system is updated by the job system - check the 'simulationUpdate')
+    Vector2 incrementation = Vector2Scale(player->velocity, step * PLAYER_REFERENCE_FPS);
+    incrementation.x = floatingOriginSnap(incrementation.x);
+
+    playerIncrementPosition(incrementation);
 
-    // Oh, and don't forget about other things!
-    particleSystemUpdate(&player->particle_system);
+    player->particle_system.target = player->position;
 }
 
 void playerRender() {
-    Player* player = &GlobalState.player;
+    Player* player = &GlobalState.simulation.player;
 
     // it's funny how this one simple rotation interpolation causes the submarine to feel floppy...
     player->sprite_rotation = Lerp(
         player->sprite_rotation,
-        GlobalState.player.velocity.y * (PLAYER_GRAVITY_Y / 4.0f),
+        GlobalState.simulation.player.velocity.y * (PLAYER_GRAVITY_Y / 4.0f),
         PLAYER_GRAVITY_Y * GetFrameTime()
     );
 
@@ -1004,7 +2431,7 @@ void playerRender() {
         PLAYER_GRAVITY_Y * 3
     );
 
-    particleSystemRender(&player->particle_system);
+    particleSystemRender(&player->particle_system, GlobalState.visibility.particles, GlobalState.visibility.particle_count);
 
     DrawTexturePro(
         GlobalState.Resources.texture_player, 
@@ -1027,7 +2454,7 @@ void playerRender() {
 }
 
 void playerRenderScore(Vector2 position, Vector2 text_offset) {
-    Player* player = &GlobalState.player;
+    Player* player = &GlobalState.simulation.player;
     int sprite_width = GlobalState.Resources.texture_collectibles[0].width + text_offset.x;
     int sprite_height = GlobalState.Resources.texture_collectibles[0].height + text_offset.y;
 
@@ -1057,7 +2484,7 @@ void playerRenderScore(Vector2 position, Vector2 text_offset) {
 
     DrawTextPro(
         RESOURCES_FONT_LARGE,
-        TextFormat("%u\n%u\n%u", player->collected_common, player->collected_rare, player->collected_legendary), 
+        frameArenaFormat(&GlobalState.frame_arena, "%u\n%u\n%u", player->collected[ENTITY_COLLECTIBLE_COMMON], player->collected[ENTITY_COLLECTIBLE_RARE], player->collected[ENTITY_COLLECTIBLE_LEGENDARY]), 
         (Vector2) {
             position.x + sprite_width, 
             position.y - text_offset.y
@@ -1071,550 +2498,3086 @@ void playerRenderScore(Vector2 position, Vector2 text_offset) {
 }
 
 bool playerInputGetPress() {
+    if(GlobalState.autopilot.active) {
+        return GlobalState.autopilot.down && !GlobalState.autopilot.down_prev;
+    }
+
     return IsKeyPressed(KEY_SPACE) || IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || GetTouchPointCount() > 0;
 }
 
 bool playerInputGetRelease() {
+    if(GlobalState.autopilot.active) {
+        return !GlobalState.autopilot.down && GlobalState.autopilot.down_prev;
+    }
+
     return IsKeyReleased(KEY_SPACE) || IsMouseButtonReleased(MOUSE_BUTTON_LEFT) || GetTouchPointCount() <= 0;
 }
 
 bool playerInputGetDown() {
+    if(GlobalState.autopilot.active) {
+        return GlobalState.autopilot.down;
+    }
+
     return IsKeyDown(KEY_SPACE) || IsMouseButtonDown(MOUSE_BUTTON_LEFT) || GetTouchPointCount() > 0;
 }
 
 void playerSetPosition(Vector2 position) {
-    GlobalState.player.position_prev = GlobalState.player.position;
-    GlobalState.player.position = position;
+    GlobalState.simulation.player.position_prev = GlobalState.simulation.player.position;
+    GlobalState.simulation.player.position = position;
 }
 
 void playerIncrementPosition(Vector2 incrementation) {
-    GlobalState.player.position_prev = GlobalState.player.position;
-    GlobalState.player.position = Vector2Add(GlobalState.player.position, incrementation);
+    GlobalState.simulation.player.position_prev = GlobalState.simulation.player.position;
+    GlobalState.simulation.player.position = Vector2Add(GlobalState.simulation.player.position, incrementation);
 }
 
 void playerSetVelocity(Vector2 velocity) {
-    GlobalState.player.velocity = velocity;
+    GlobalState.simulation.player.velocity = velocity;
 }
 
 void playerCheckCollisions() {
-    Player* player = &GlobalState.player;
+    Player* player = &GlobalState.simulation.player;
 
-    for(int obstacles_to_check = 0; obstacles_to_check < OBSTACLE_CAPACITY - 1; obstacles_to_check++) {
-        Obstacle* obstacle = &GlobalState.obstacle_list.list[obstacles_to_check];
-        Obstacle* obstacle_next = &GlobalState.obstacle_list.list[obstacles_to_check + 1];
+    Rectangle player_rect = { 
+        player->position.x - (player->physical_size.x / 2.0f), 
+        player->position.y - (player->physical_size.y / 2.0f), 
+        player->physical_size.x, 
+        player->physical_size.y 
+    };
 
-        Rectangle player_rect = { 
-            player->position.x - (player->physical_size.x / 2.0f), 
-            player->position.y - (player->physical_size.y / 2.0f), 
-            player->physical_size.x, 
-            player->physical_size.y 
-        };
+    // The walls are checked against the corridor's heightfield: 
+    // we're only looking for the lowest point of the ceiling and the highest point of the floor under the player.
+    float corridor_top = 0.0f;
+    float corridor_bottom = 0.0f;
 
-        Vector2 points0[4] = {
-            obstacle->point0,
-            obstacle_next->point0,
-            (Vector2) { obstacle->point0.x + OBSTACLE_WIDTH / 2.0f, obstacle->point0.y },
-            (Vector2) { obstacle_next->point0.x - OBSTACLE_WIDTH / 2.0f, obstacle_next->point0.y }
-        };
+    if(obstacleListGetCorridor(player_rect.x, player_rect.x + player_rect.width, &corridor_top, &corridor_bottom)) {
+        if(player_rect.y < corridor_top || player_rect.y + player_rect.height > corridor_bottom) {
+            player->game_over = true;
+        }
+    }
+
+    // Picking up the entities: only the ones in the grid cells under the player are tested (check the 'SpatialGrid').
+    // Removing an entity moves another one into its place, so the hits are turned into the handles before any of them is removed.
+    EntityStore* entities = &GlobalState.simulation.entities;
+    const int type_points[ENTITY_TYPE_COUNT] = ENTITY_TYPE_POINTS;
+
+    int hits[SPATIAL_GRID_QUERY_CAPACITY];
+    EntityHandle hit_handles[SPATIAL_GRID_QUERY_CAPACITY];
+    int hit_count = spatialGridQuery(&GlobalState.entity_grid, player_rect, hits, SPATIAL_GRID_QUERY_CAPACITY);
+
+    for(int i = 0; i < hit_count; i++) {
+        hit_handles[i] = entityStoreGetHandle(entities, hits[i]);
+    }
+
+    for(int i = 0; i < hit_count; i++) {
+        int index = entityStoreFind(entities, hit_handles[i]);
+
+        player->points += type_points[entities->type[index]];
+        player->collected[entities->type[index]]++;
+
+        PlaySound(GlobalState.Resources.sound_collectible_pickup);
+
+        entityStoreRemoveAt(entities, index);
+    }
+}
+
+Obstacle obstacleInit(Vector2 position, float distance) {
+    Obstacle result = {
+        .position = position,
+        .distance = distance,
+
+        .point0.x = position.x,
+        .point1.x = position.x,
+    };
+
+    result.point0.y = position.y - (distance / 2.0f);
+    result.point1.y = position.y + (distance / 2.0f);
+
+    return result;
+}
+
+void obstacleBuildHeightfield(Obstacle* obstacle, Obstacle* obstacle_prev) {
+    // The spline is evaluated relatively to the previous obstacle, so the heightfield is the same wherever the origin is
+    float start = obstacle_prev->position.x;
+
+    Vector2 points0[4] = {
+        { obstacle_prev->point0.x - start, obstacle_prev->point0.y },
+        { obstacle->point0.x - start, obstacle->point0.y },
+        { obstacle_prev->point0.x - start + OBSTACLE_WIDTH / 2.0f, obstacle_prev->point0.y },
+        { obstacle->point0.x - start - OBSTACLE_WIDTH / 2.0f, obstacle->point0.y }
+    };
+
+    Vector2 points1[4] = {
+        { obstacle_prev->point1.x - start, obstacle_prev->point1.y },
+        { obstacle->point1.x - start, obstacle->point1.y },
+        { obstacle_prev->point1.x - start + OBSTACLE_WIDTH / 2.0f, obstacle_prev->point1.y },
+        { obstacle->point1.x - start - OBSTACLE_WIDTH / 2.0f, obstacle->point1.y }
+    };
+
+    for(int bucket = 0; bucket < OBSTACLE_HEIGHTFIELD_RESOLUTION; bucket++) {
+        obstacle->height0[bucket] = 0.0f;
+        obstacle->height1[bucket] = worldGetSize().y;
+    }
+
+    // Both the 'x' and the 'y' are monotonic, so every bucket touched by the samples' bounding box takes its extreme (conservative)
+    Vector2 samples0[OBSTACLE_SEGMENT_RESOLUTION + 1];
+    Vector2 samples1[OBSTACLE_SEGMENT_RESOLUTION + 1];
+
+    splineEvaluateForward(points0[0], points0[2], points0[3], points0[1], samples0);
+    splineEvaluateForward(points1[0], points1[2], points1[3], points1[1], samples1);
+
+    Vector2 sample0_prev = samples0[0];
+    Vector2 sample1_prev = samples1[0];
+
+    for(int i = 1; i <= OBSTACLE_SEGMENT_RESOLUTION; i++) {
+        Vector2 sample0 = samples0[i];
+        Vector2 sample1 = samples1[i];
+
+        // (Both walls share the same 'x', only the 'y' is different)
+        int bucket_first = Clamp(sample0_prev.x / OBSTACLE_HEIGHTFIELD_STEP, 0, OBSTACLE_HEIGHTFIELD_RESOLUTION - 1);
+        int bucket_last = Clamp(sample0.x / OBSTACLE_HEIGHTFIELD_STEP, 0, OBSTACLE_HEIGHTFIELD_RESOLUTION - 1);
+
+        for(int bucket = bucket_first; bucket <= bucket_last; bucket++) {
+            obstacle->height0[bucket] = fmaxf(obstacle->height0[bucket], fmaxf(sample0_prev.y, sample0.y));
+            obstacle->height1[bucket] = fminf(obstacle->height1[bucket], fminf(sample1_prev.y, sample1.y));
+        }
+
+        sample0_prev = sample0;
+        sample1_prev = sample1;
+    }
+}
+
+int collectibleSpawn(Obstacle* obstacle, Random* random, Entity* spawns) {
+    // Simple check if there is a space for collectible to be spawned
+    if(obstacle->distance <= COLLECTLIBLE_RADIUS * 2.0f) {
+        return 0;
+    }
+
+    // RNG that picks if the collectible will be spawned
+    if(randomGetValue(random, 0, COLLECTIBLE_SPAWN_CHANCE) != COLLECTIBLE_SPAWN_CHANCE_VALUE) {
+        return 0;
+    }
+
+    Entity* collectible = &spawns[0];
+
+    *collectible = (Entity) { 
+        .position = (Vector2) { 
+            obstacle->position.x - randomGetValue(
+                random,
+                (OBSTACLE_WIDTH / -2.0f) + (COLLECTLIBLE_RADIUS * 2.0f), 
+                (OBSTACLE_WIDTH / 2.0f) - (COLLECTLIBLE_RADIUS * 2.0f)
+            ),
+            // This formula either substracts or add a value, which is in between the point0 and point1 from the position.y value. It accounts the radius of the collectible
+            obstacle->position.y - randomGetValue(
+                random,
+                (obstacle->distance / -2.0f) + (COLLECTLIBLE_RADIUS * 2.0f), 
+                (obstacle->distance / 2.0f) - (COLLECTLIBLE_RADIUS * 2.0f)
+            )
+        },
+        .rotation = randomGetValue(random, -30, 30),
+        .radius = COLLECTLIBLE_RADIUS
+    };
+
+    // 'collectible_rarity_random_index' picks the random value...
+    int collectible_rarity_random_index = randomGetValue(random, 0, 30);
+    // .. which then helps us assign the proper rarity to our collectible.
+
+    if(collectible_rarity_random_index >= 0 && collectible_rarity_random_index < 16) { // If 'collectible_rarity_random_index' is in range 0 - 15, then the rarity is ENTITY_COLLECTIBLE_COMMON (50%)
+        collectible->type = ENTITY_COLLECTIBLE_COMMON;
+    } else if(collectible_rarity_random_index >= 16 && collectible_rarity_random_index < 26) { // Otherwise, if 'collectible_rarity_random_index' is in range 16 - 25, then the rarity is ENTITY_COLLECTIBLE_RARE (33%)
+        collectible->type = ENTITY_COLLECTIBLE_RARE;
+    } else if(collectible_rarity_random_index >= 26 && collectible_rarity_random_index < 31) { // lastly, if 'collectible_rarity_random_index' is in range 26 - 30, then the rarity is ENTITY_COLLECTIBLE_LEGENDARY (17%)
+        collectible->type = ENTITY_COLLECTIBLE_LEGENDARY;
+    }
+
+    collectible->sprite = collectible->type;
+
+    // The collectible drifts towards the lower point of its obstacle, slowing down as it gets closer:
+    // the velocity is the 'COLLECTIBLE_DRIFT' of the distance, and the drag takes the same fraction of the velocity away (check the 'ENTITY_TYPE_DRAG')
+    Vector2 drift_target = { obstacle->point1.x, obstacle->point1.y - RESOURCES_SPRITE_COLLECTIBLES->height / 2.0f };
+    collectible->velocity = Vector2Scale(Vector2Subtract(drift_target, collectible->position), COLLECTIBLE_DRIFT);
+
+    return 1;
+}
+
+EntityHandle entityStoreAdd(EntityStore* store, Entity entity) {
+    if(store->count == ENTITY_CAPACITY) {
+        TraceLog(LOG_WARNING, "ENTITIES: Entity store is full (%i entities)", ENTITY_CAPACITY);
+        return 0;
+    }
+
+    // Recycling a freed slot first (and only then taking a fresh one)
+    int slot = 0;
+
+    if(store->free_first > 0) {
+        slot = store->free_first - 1;
+        store->free_first = store->slot_index[slot];
+    } else {
+        slot = store->slot_count++;
+    }
+
+    // (The generation is never 0, so neither is the handle)
+    if(store->slot_generation[slot] == 0) {
+        store->slot_generation[slot] = 1;
+    }
+
+    int index = store->count++;
+
+    store->position[index] = entity.position;
+    store->rotation[index] = entity.rotation;
+    store->velocity[index] = entity.velocity;
+    store->radius[index] = entity.radius;
+    store->sprite[index] = entity.sprite;
+    store->type[index] = entity.type;
+    store->slot[index] = slot;
+    store->slot_index[slot] = index;
+
+    return entityStoreGetHandle(store, index);
+}
+
+int entityStoreFind(EntityStore* store, EntityHandle handle) {
+    int slot = handle & 0xFFFF;
+
+    // (A free slot's index is the free-list's link, but its generation has moved on already)
+    if(handle == 0 || slot >= store->slot_count || store->slot_generation[slot] != handle >> 16) {
+        return -1;
+    }
+
+    return store->slot_index[slot];
+}
+
+EntityHandle entityStoreGetHandle(EntityStore* store, int index) {
+    int slot = store->slot[index];
+
+    return slot | ((EntityHandle) store->slot_generation[slot] << 16);
+}
+
+void entityStoreRemove(EntityStore* store, EntityHandle handle) {
+    int index = entityStoreFind(store, handle);
+
+    if(index >= 0) {
+        entityStoreRemoveAt(store, index);
+    }
+}
+
+void entityStoreRemoveAt(EntityStore* store, int index) {
+    int slot = store->slot[index];
+    int last = --store->count;
+
+    // The last entity fills the gap (so the arrays stay packed), and its slot follows it
+    store->position[index] = store->position[last];
+    store->rotation[index] = store->rotation[last];
+    store->velocity[index] = store->velocity[last];
+    store->radius[index] = store->radius[last];
+    store->sprite[index] = store->sprite[last];
+    store->type[index] = store->type[last];
+    store->slot[index] = store->slot[last];
+    store->slot_index[store->slot[index]] = index;
+
+    // The slot goes to the free-list, and the handles to it are invalidated
+    store->slot_generation[slot]++;
+    store->slot_index[slot] = store->free_first;
+    store->free_first = slot + 1;
+}
+
+void entityStoreRemoveBehind(EntityStore* store, float x) {
+    int write = 0;
+
+    // A compaction pass: every entity is written at the cursor, but only the kept ones move it forward.
+    // The removed ones go to the free-list with the same mask (so there's no branch in the loop, and the kept ones stay in order)
+    for(int i = 0; i < store->count; i++) {
+        int slot = store->slot[i];
+        int keep = store->position[i].x + store->radius[i] >= x;
+
+        store->position[write] = store->position[i];
+        store->rotation[write] = store->rotation[i];
+        store->velocity[write] = store->velocity[i];
+        store->radius[write] = store->radius[i];
+        store->sprite[write] = store->sprite[i];
+        store->type[write] = store->type[i];
+        store->slot[write] = slot;
+
+        // A kept slot points at its new index, and a removed one links to the previous head of the free-list
+        store->slot_index[slot] = keep * write + (1 - keep) * store->free_first;
+        store->slot_generation[slot] += 1 - keep;
+        store->free_first += (1 - keep) * (slot + 1 - store->free_first);
+
+        write += keep;
+    }
+
+    store->count = write;
+}
+
+void entityStoreUpdate(EntityStore* store, float step) {
+    // The drag of every type for this step (so the loop below only looks it up)
+    const float type_drag[ENTITY_TYPE_COUNT] = ENTITY_TYPE_DRAG;
+    float damping[ENTITY_TYPE_COUNT];
+
+    for(int type = 0; type < ENTITY_TYPE_COUNT; type++) {
+        damping[type] = 1.0f - type_drag[type] * step;
+    }
+
+    for(int i = 0; i < store->count; i++) {
+        store->position[i].x += floatingOriginSnap(store->velocity[i].x * step);
+        store->position[i].y += store->velocity[i].y * step;
+
+        store->velocity[i].x *= damping[store->type[i]];
+        store->velocity[i].y *= damping[store->type[i]];
+    }
+}
+
+void entityStoreShift(EntityStore* store, float shift) {
+    for(int i = 0; i < store->count; i++) {
+        store->position[i].x -= shift;
+    }
+}
+
+int entityStoreCull(EntityStore* store, Rectangle bounds, int* visible) {
+    int visible_count = 0;
+
+    // (Every entity is written, but only the visible ones move the count forward, so there's no branch in the loop)
+    for(int i = 0; i < store->count; i++) {
+        visible[visible_count] = i;
+        visible_count += collisionCheckCircleRec(store->position[i], store->radius[i], bounds);
+    }
+
+    return visible_count;
+}
+
+void entityStoreRender(EntityStore* store, const int* visible, int visible_count) {
+    for(int i = 0; i < visible_count; i++) {
+        int index = visible[i];
+        Texture2D texture = GlobalState.Resources.texture_collectibles[store->sprite[index]];
+
+        DrawTexturePro(
+            texture,
+            (Rectangle) { 0, 0, texture.width, texture.height },
+            (Rectangle) {
+                store->position[index].x,
+                store->position[index].y,
+                store->radius[index] * 2.0f,
+                store->radius[index] * 2.0f
+            },
+            (Vector2) { store->radius[index], store->radius[index] },
+            store->rotation[index],
+            WHITE
+        );
+    }
+}
+
+void spatialGridBuild(SpatialGrid* grid, EntityStore* store) {
+    int* bucket_start = grid->bucket_start;
+
+    memset(bucket_start, 0, sizeof(grid->bucket_start));
+    grid->entry_count = store->count;
+    grid->radius_max = 0.0f;
+
+    // Counting the entities of every bucket...
+    for(int i = 0; i < store->count; i++) {
+        int cell_x = floorf(store->position[i].x / SPATIAL_GRID_CELL_SIZE);
+        int cell_y = floorf(store->position[i].y / SPATIAL_GRID_CELL_SIZE);
+        uint32_t bucket = spatialGridHash(cell_x, cell_y);
+
+        grid->entity_bucket[i] = bucket;
+        grid->entity_cell[i] = (uint16_t) cell_x | ((uint32_t) (uint16_t) cell_y << 16);
+        grid->radius_max = fmaxf(grid->radius_max, store->radius[i]);
+        bucket_start[bucket]++;
+    }
+
+    // ... turning the counts into where every bucket ends...
+    for(int bucket = 1; bucket < SPATIAL_GRID_BUCKET_COUNT; bucket++) {
+        bucket_start[bucket] += bucket_start[bucket - 1];
+    }
+
+    bucket_start[SPATIAL_GRID_BUCKET_COUNT] = store->count;
+
+    // ... and filling every bucket from its end (backwards, so the entities of a bucket stay in the store's order).
+    // Once a bucket is filled, its end has moved to its start.
+    for(int i = store->count - 1; i >= 0; i--) {
+        int entry = --bucket_start[grid->entity_bucket[i]];
+
+        grid->entry_index[entry] = i;
+        grid->entry_cell[entry] = grid->entity_cell[i];
+        grid->entry_position[entry] = store->position[i];
+        grid->entry_radius[entry] = store->radius[i];
+    }
+}
+
+int spatialGridQuery(SpatialGrid* grid, Rectangle rect, int* results, int capacity) {
+    int result_count = 0;
+
+    int cell_x_first = floorf((rect.x - grid->radius_max) / SPATIAL_GRID_CELL_SIZE);
+    int cell_y_first = floorf((rect.y - grid->radius_max) / SPATIAL_GRID_CELL_SIZE);
+    int cell_x_last = floorf((rect.x + rect.width + grid->radius_max) / SPATIAL_GRID_CELL_SIZE);
+    int cell_y_last = floorf((rect.y + rect.height + grid->radius_max) / SPATIAL_GRID_CELL_SIZE);
+
+    for(int cell_y = cell_y_first; cell_y <= cell_y_last; cell_y++) {
+        for(int cell_x = cell_x_first; cell_x <= cell_x_last; cell_x++) {
+            uint32_t bucket = spatialGridHash(cell_x, cell_y);
+            uint32_t cell = (uint16_t) cell_x | ((uint32_t) (uint16_t) cell_y << 16);
+
+            // (The other cells of the bucket are skipped, so an entity is never returned twice, even if two of the cells share the bucket)
+            for(int entry = grid->bucket_start[bucket]; entry < grid->bucket_start[bucket + 1]; entry++) {
+                if(grid->entry_cell[entry] == cell && collisionCheckCircleRec(grid->entry_position[entry], grid->entry_radius[entry], rect)) {
+                    if(result_count == capacity) {
+                        return result_count;
+                    }
+
+                    results[result_count++] = grid->entry_index[entry];
+                }
+            }
+        }
+    }
+
+    return result_count;
+}
+
+int spatialGridQueryCircle(SpatialGrid* grid, Vector2 center, float radius, int* results, int capacity) {
+    int result_count = 0;
+    float reach = radius + grid->radius_max;
+
+    int cell_x_first = floorf((center.x - reach) / SPATIAL_GRID_CELL_SIZE);
+    int cell_y_first = floorf((center.y - reach) / SPATIAL_GRID_CELL_SIZE);
+    int cell_x_last = floorf((center.x + reach) / SPATIAL_GRID_CELL_SIZE);
+    int cell_y_last = floorf((center.y + reach) / SPATIAL_GRID_CELL_SIZE);
+
+    for(int cell_y = cell_y_first; cell_y <= cell_y_last; cell_y++) {
+        for(int cell_x = cell_x_first; cell_x <= cell_x_last; cell_x++) {
+            uint32_t bucket = spatialGridHash(cell_x, cell_y);
+            uint32_t cell = (uint16_t) cell_x | ((uint32_t) (uint16_t) cell_y << 16);
+
+            for(int entry = grid->bucket_start[bucket]; entry < grid->bucket_start[bucket + 1]; entry++) {
+                float distance_x = grid->entry_position[entry].x - center.x;
+                float distance_y = grid->entry_position[entry].y - center.y;
+                float distance_max = radius + grid->entry_radius[entry];
+
+                if(grid->entry_cell[entry] == cell && distance_x * distance_x + distance_y * distance_y <= distance_max * distance_max) {
+                    if(result_count == capacity) {
+                        return result_count;
+                    }
+
+                    results[result_count++] = grid->entry_index[entry];
+                }
+            }
+        }
+    }
+
+    return result_count;
+}
+
+ObstacleList obstacleListInit(EntityStore* entities) {
+    ObstacleList result = { 0 };
+    ObstacleStream* stream = &GlobalState.obstacle_stream;
+
+    Vector2 obstacle_position = { 0.0f, worldGetSize().y / 2.0f };
+    float obstacle_distance = OBSTACLE_DIST_INITIAL;
+
+    // The first obstacle is placed by hand, everything after it comes from the generator
+    result.list[0] = obstacleInit(obstacle_position, obstacle_distance);
+    result.random = randomInit(GetRandomValue(1, INT32_MAX));
+    result.generated_count = 1;
+
+    obstacleStreamReset(stream, &result.list[0], result.random, result.generated_count);
+
+    for(int obstacle_index = 1; obstacle_index < OBSTACLE_CAPACITY; obstacle_index++) {
+        obstacleStreamPop(stream, &result, obstacle_index, entities);
+    }
+
+    return result;
+}
+
+void obstacleInitData(Obstacle* obstacle, Vector2* position, float* distance, Random* random) {
+    int obstacle_move_direction = 0;
+
+    // RNG that picks the horizontal direction that the next obstacle will be placed (1 - 5 -> up; (-1) - (-5) -> down)
+    do {
+        obstacle_move_direction = randomGetValue(random, -5, 5);
+    } while(obstacle_move_direction == 0);
+
+    *position = (Vector2) {
+        obstacle->position.x + OBSTACLE_WIDTH,
+        obstacle->position.y + obstacle_move_direction * (OBSTACLE_DIST_REDUCTION * 2)
+    };
+
+    *distance = obstacle->distance >= OBSTACLE_DIST_MIN ?
+        obstacle->distance - OBSTACLE_DIST_REDUCTION * randomGetValue(random, 1, 2) :
+        obstacle->distance;
+
+    position->y = Clamp(position->y, *distance / 2.0f + 32.0f, worldGetSize().y - *distance / 2.0f - 32.0f);
+}
+
+void obstacleListRender() {
+    if(GlobalState.corridor_renderer.enabled) {
+        corridorRendererRender(&GlobalState.corridor_renderer);
+    } else {
+        obstacleListRenderWalls();
+    }
+
+    entityStoreRender(&GlobalState.simulation.entities, GlobalState.visibility.entities, GlobalState.visibility.entity_count);
+}
+
+void obstacleListRenderWalls() {
+    RenderVisibility* visibility = &GlobalState.visibility;
+
+    for(int i = 0; i < visibility->segment_count; i++) {
+        int obstacle_index = visibility->segments[i];
+
+        Obstacle* obstacle_current = &GlobalState.simulation.obstacle_list.list[obstacle_index];
+        Obstacle* obstacle_next = &GlobalState.simulation.obstacle_list.list[obstacle_index + 1];
+        
+
+        Vector2 points0[4] = {
+            obstacle_current->point0,
+            obstacle_next->point0,
+            (Vector2) { obstacle_current->point0.x + OBSTACLE_WIDTH / 2.0f, obstacle_current->point0.y },
+            (Vector2) { obstacle_next->point0.x - OBSTACLE_WIDTH / 2.0f, obstacle_next->point0.y }
+        };
+
+        Vector2 points1[4] = {
+            obstacle_current->point1,
+            obstacle_next->point1,
+            (Vector2) { obstacle_current->point1.x + OBSTACLE_WIDTH / 2.0f, obstacle_current->point1.y },
+            (Vector2) { obstacle_next->point1.x - OBSTACLE_WIDTH / 2.0f, obstacle_next->point1.y }
+        };
+
+        // The walls are filled straight from the heightfield (one column per bucket, so the columns never overlap).
+        // The segments at the screen's edges are only partially visible, so the buckets are clipped to the camera's bounds.
+        int bucket_first = Clamp(floorf((visibility->bounds.x - obstacle_current->position.x) / OBSTACLE_HEIGHTFIELD_STEP), 0, OBSTACLE_HEIGHTFIELD_RESOLUTION - 1);
+        int bucket_last = Clamp(floorf((visibility->bounds.x + visibility->bounds.width - obstacle_current->position.x) / OBSTACLE_HEIGHTFIELD_STEP), 0, OBSTACLE_HEIGHTFIELD_RESOLUTION - 1);
+
+        for(int bucket = bucket_first; bucket <= bucket_last; bucket++) {
+            float bucket_x = obstacle_current->position.x + bucket * OBSTACLE_HEIGHTFIELD_STEP;
+
+            DrawRectangleGradientV(
+                bucket_x, 
+                0.0f, 
+                OBSTACLE_HEIGHTFIELD_STEP, 
+                obstacle_next->height0[bucket], 
+                GetColor(OBSTACLE_UPPER_COLOR_TOP), 
+                GetColor(OBSTACLE_UPPER_COLOR)
+            );
+
+            DrawRectangleGradientV(
+                bucket_x, 
+                obstacle_next->height1[bucket], 
+                OBSTACLE_HEIGHTFIELD_STEP, 
+                worldGetSize().y + 1 - obstacle_next->height1[bucket], 
+                GetColor(OBSTACLE_LOWER_COLOR),
+                GetColor(OBSTACLE_LOWER_COLOR_BOTTOM) 
+            );
+        }
+
+        DrawSplineSegmentBezierCubic(
+            points0[0], 
+            points0[2], 
+            points0[3], 
+            points0[1], 
+            OBSTACLE_LINE_THICKNESS,
+            GetColor(GAME_LINES_COLOR)    
+        );
+
+        DrawSplineSegmentBezierCubic(
+            points1[0], 
+            points1[2], 
+            points1[3], 
+            points1[1], 
+            OBSTACLE_LINE_THICKNESS,
+            GetColor(GAME_LINES_COLOR)
+        );
+    }
+}
+
+int obstacleListCullSegments(Rectangle bounds, int* visible) {
+    int visible_count = 0;
+
+    for(int i = 0; i < OBSTACLE_CAPACITY - 1; i++) {
+        float segment_start = GlobalState.simulation.obstacle_list.list[i].position.x;
+        float segment_end = GlobalState.simulation.obstacle_list.list[i + 1].position.x;
+
+        if(segment_end >= bounds.x && segment_start <= bounds.x + bounds.width) {
+            visible[visible_count++] = i;
+        }
+    }
+
+    return visible_count;
+}
+
+int obstacleListCullStrips(Rectangle bounds, CorridorStrip* strips, int capacity) {
+    int strip_count = 0;
+
+    // The strips are aligned to the first obstacle, so they never cross the segment boundaries
+    float origin = GlobalState.simulation.obstacle_list.list[0].position.x;
+    int strip_first = floorf((bounds.x - origin) / RENDER_STRIP_WIDTH);
+    int strip_last = ceilf((bounds.x + bounds.width - origin) / RENDER_STRIP_WIDTH) - 1;
+    int strip_buckets = RENDER_STRIP_WIDTH / OBSTACLE_HEIGHTFIELD_STEP;
+
+    for(int strip_index = strip_first; strip_index <= strip_last && strip_count < capacity; strip_index++) {
+        CorridorStrip* strip = &strips[strip_count++];
+        float strip_offset = strip_index * RENDER_STRIP_WIDTH;
+
+        *strip = (CorridorStrip) {
+            .x = origin + strip_offset,
+            .width = RENDER_STRIP_WIDTH,
+            .ceiling_min = 0.0f,
+            .ceiling_max = 0.0f,
+            .floor_min = worldGetSize().y + 1,
+            .floor_max = worldGetSize().y + 1,
+            .has_walls = false
+        };
+
+        int segment = floorf(strip_offset / OBSTACLE_WIDTH);
+
+        if(segment < 0 || segment >= OBSTACLE_CAPACITY - 1) {
+            continue;
+        }
+
+        // The heightfield of the segment 'n' is stored in the 'list[n + 1]' (check the 'obstacleBuildHeightfield')
+        Obstacle* obstacle = &GlobalState.simulation.obstacle_list.list[segment + 1];
+        int bucket_first = (strip_offset - segment * OBSTACLE_WIDTH) / OBSTACLE_HEIGHTFIELD_STEP;
+        int bucket_last = bucket_first + strip_buckets - 1;
+
+        strip->has_walls = true;
+        strip->ceiling_min = strip->ceiling_max = obstacle->height0[bucket_first];
+        strip->floor_min = strip->floor_max = obstacle->height1[bucket_first];
+
+        // The buckets only know the lowest point of the ceiling and the highest point of the floor.
+        // The walls are monotonic within the segment, so the other extreme of every bucket is the neighbouring bucket's value.
+        int neighbour_first = bucket_first > 0 ? bucket_first - 1 : bucket_first;
+        int neighbour_last = bucket_last < OBSTACLE_HEIGHTFIELD_RESOLUTION - 1 ? bucket_last + 1 : bucket_last;
+
+        for(int bucket = neighbour_first; bucket <= neighbour_last; bucket++) {
+            strip->ceiling_min = fminf(strip->ceiling_min, obstacle->height0[bucket]);
+            strip->floor_max = fmaxf(strip->floor_max, obstacle->height1[bucket]);
+        }
+
+        for(int bucket = bucket_first; bucket <= bucket_last; bucket++) {
+            strip->ceiling_max = fmaxf(strip->ceiling_max, obstacle->height0[bucket]);
+            strip->floor_min = fminf(strip->floor_min, obstacle->height1[bucket]);
+        }
+    }
+
+    return strip_count;
+}
+
+bool obstacleListGetCorridor(float left, float right, float* top, float* bottom) {
+    ObstacleList* obstacle_list = &GlobalState.simulation.obstacle_list;
+    float corridor_start = obstacle_list->list[0].position.x;
+
+    // The obstacles are placed every 'OBSTACLE_WIDTH' units, so both the segment and the bucket are computed directly from the 'x'
+    int bucket_first = floorf((left - corridor_start) / OBSTACLE_HEIGHTFIELD_STEP);
+    int bucket_last = floorf((right - corridor_start) / OBSTACLE_HEIGHTFIELD_STEP);
+
+    bucket_first = Clamp(bucket_first, 0, (OBSTACLE_CAPACITY - 1) * OBSTACLE_HEIGHTFIELD_RESOLUTION - 1);
+    bucket_last = Clamp(bucket_last, 0, (OBSTACLE_CAPACITY - 1) * OBSTACLE_HEIGHTFIELD_RESOLUTION - 1);
+
+    // Outside of the corridor (it shouldn't happen, but there's nothing to collide with)
+    if(right < corridor_start || left > obstacle_list->list[OBSTACLE_CAPACITY - 1].position.x) {
+        return false;
+    }
+
+    *top = 0.0f;
+    *bottom = worldGetSize().y;
+
+    for(int bucket = bucket_first; bucket <= bucket_last; bucket++) {
+        // The heightfield of the segment in between 'list[n]' and 'list[n + 1]' is stored in the 'list[n + 1]'
+        Obstacle* obstacle = &obstacle_list->list[bucket / OBSTACLE_HEIGHTFIELD_RESOLUTION + 1];
+
+        *top = fmaxf(*top, obstacle->height0[bucket % OBSTACLE_HEIGHTFIELD_RESOLUTION]);
+        *bottom = fminf(*bottom, obstacle->height1[bucket % OBSTACLE_HEIGHTFIELD_RESOLUTION]);
+    }
+
+    return true;
+}
+
+void obstacleListLoopObstacles() {
+    ObstacleList* obstacle_list = &GlobalState.simulation.obstacle_list;
+    ObstacleStream* stream = &GlobalState.obstacle_stream;
+    Obstacle* obstacle_current = &obstacle_list->list[0];
+        
+    if(GetWorldToScreen2D(obstacle_current->position, GlobalState.simulation.camera).x < -OBSTACLE_WIDTH) {
+        for(int i = 0; i < OBSTACLE_CAPACITY - 1; i++) {
+            obstacle_list->list[i] = obstacle_list->list[i + 1];
+        }
+
+        // The next obstacle is already waiting in the stream (it was generated ahead of the camera)
+        obstacleStreamPop(stream, obstacle_list, OBSTACLE_CAPACITY - 1, &GlobalState.simulation.entities);
+
+        // The entities that came with the dropped obstacle are gone with it (nothing to the left of the first obstacle's corridor is ever visible)
+        entityStoreRemoveBehind(&GlobalState.simulation.entities, obstacle_list->list[0].position.x - OBSTACLE_WIDTH / 2.0f);
+    }
+
+    // Refilling the stream in the background, so it never runs dry
+    obstacleStreamRequest(stream);
+}
+
+void obstacleStreamReset(ObstacleStream* stream, Obstacle* obstacle_last, Random random, int generated_count) {
+    // The generator from the previous game (or from before the rewind) might still be running
+    jobSystemWait(&GlobalState.job_system, &stream->counter);
+
+    atomic_store(&stream->head, 0);
+    atomic_store(&stream->tail, 0);
+
+    // (Everything generated so far is dropped; the generator continues right after the 'obstacle_last')
+    stream->obstacle_last = *obstacle_last;
+    stream->random = random;
+    stream->generated_count = generated_count;
+
+    obstacleStreamRequest(stream);
+}
+
+void obstacleStreamRequest(ObstacleStream* stream) {
+    // NOTE: Only the consumer requests the generation, so there's no race in between the check and the submission
+    if(!jobCounterIsDone(&stream->counter)) {
+        return;
+    }
+
+    unsigned int head = atomic_load_explicit(&stream->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&stream->tail, memory_order_relaxed);
+
+    if(tail - head < OBSTACLE_STREAM_CAPACITY) {
+        jobSystemSubmit(&GlobalState.job_system, obstacleStreamGenerateJob, stream, &stream->counter);
+    }
+}
+
+bool obstacleStreamPop(ObstacleStream* stream, ObstacleList* obstacle_list, int obstacle_index, EntityStore* entities) {
+    unsigned int head = atomic_load_explicit(&stream->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&stream->tail, memory_order_acquire);
+
+    // The generator didn't keep up (or wasn't scheduled yet, e.g. on the Web), so we're waiting for it right here.
+    // 'jobSystemWait' runs the pending jobs on this thread, so in the worst case the obstacle is generated synchronously.
+    if(head == tail) {
+        obstacleStreamRequest(stream);
+        jobSystemWait(&GlobalState.job_system, &stream->counter);
+
+        tail = atomic_load_explicit(&stream->tail, memory_order_acquire);
+
+        if(head == tail) {
+            TraceLog(LOG_WARNING, "OBSTACLES: Obstacle stream is empty");
+            return false;
+        }
+    }
+
+    // The list takes over the generator's state as well, so it can restart the stream from its last obstacle
+    obstacle_list->list[obstacle_index] = stream->obstacles[head % OBSTACLE_STREAM_CAPACITY];
+    obstacle_list->random = stream->randoms[head % OBSTACLE_STREAM_CAPACITY];
+    obstacle_list->generated_count++;
+
+    for(int i = 0; i < stream->spawn_counts[head % OBSTACLE_STREAM_CAPACITY]; i++) {
+        entityStoreAdd(entities, stream->spawns[head % OBSTACLE_STREAM_CAPACITY][i]);
+    }
+
+    atomic_store_explicit(&stream->head, head + 1, memory_order_release);
+
+    return true;
+}
+
+void obstacleStreamGenerateJob(void* data) {
+    ObstacleStream* stream = (ObstacleStream*) data;
+
+    unsigned int tail = atomic_load_explicit(&stream->tail, memory_order_relaxed);
+
+    // Generating until the stream is full (the consumer could free some space in the meantime, that's fine)
+    while(tail - atomic_load_explicit(&stream->head, memory_order_acquire) < OBSTACLE_STREAM_CAPACITY) {
+        Obstacle* obstacle = &stream->obstacles[tail % OBSTACLE_STREAM_CAPACITY];
+
+        Vector2 obstacle_position = { 0 };
+        float obstacle_distance = 0.0f;
+
+        obstacleInitData(&stream->obstacle_last, &obstacle_position, &obstacle_distance, &stream->random);
+
+        *obstacle = obstacleInit(obstacle_position, obstacle_distance);
+
+        // The first few obstacles (the ones that are visible on the start screen) are left without the collectibles
+        stream->spawn_counts[tail % OBSTACLE_STREAM_CAPACITY] = stream->generated_count >= OBSTACLE_CAPACITY / 2 ?
+            collectibleSpawn(obstacle, &stream->random, stream->spawns[tail % OBSTACLE_STREAM_CAPACITY]) :
+            0;
+
+        obstacleBuildHeightfield(obstacle, &stream->obstacle_last);
+
+        stream->randoms[tail % OBSTACLE_STREAM_CAPACITY] = stream->random;
+        stream->obstacle_last = *obstacle;
+        stream->generated_count++;
+
+        // Publishing the obstacle (everything written above becomes visible to the consumer together with the new 'tail')
+        atomic_store_explicit(&stream->tail, ++tail, memory_order_release);
+    }
+}
+
+Rewind rewindInit(int capacity) {
+    Rewind result = { 0 };
+
+    // (The worst case of the delta is every word changed, so it's the whole state plus its headers)
+    int state_words = sizeof(SimulationState) / sizeof(uint32_t);
+
+    result.buffer_capacity = capacity / sizeof(uint32_t);
+    result.buffer = MemAlloc(result.buffer_capacity * sizeof(uint32_t));
+    result.scratch = MemAlloc((state_words * 2 + 1) * sizeof(uint32_t));
+
+    return result;
+}
+
+void rewindReset(Rewind* rewind, SimulationState* state) {
+    if(!rewind) {
+        return;
+    }
+
+    rewind->last = *state;
+
+    rewind->buffer_write = 0;
+    rewind->buffer_used = 0;
+    rewind->record_first = 0;
+    rewind->record_count = 0;
+    rewind->step_accumulator = 0.0f;
+}
+
+void rewindPush(Rewind* rewind, SimulationState* state) {
+    if(!rewind || !rewind->buffer) {
+        return;
+    }
+
+    double start = GetTime();
+
+    const uint32_t* current = (const uint32_t*) state;
+    uint32_t* last = (uint32_t*) &rewind->last;
+    int state_words = sizeof(SimulationState) / sizeof(uint32_t);
+    int length = 0;
+
+    // Encoding the delta (and bringing the 'last' up to date in the same pass)
+    for(int word = 0; word < state_words; ) {
+        uint32_t skip_count = 0;
+        uint32_t literal_count = 0;
+
+        while(word < state_words && skip_count < 0xFFFF && current[word] == last[word]) {
+            skip_count++;
+            word++;
+        }
+
+        int header = length++;
+
+        while(word < state_words && literal_count < 0xFFFF && current[word] != last[word]) {
+            rewind->scratch[length++] = current[word] ^ last[word];
+            last[word] = current[word];
+            literal_count++;
+            word++;
+        }
+
+        rewind->scratch[header] = skip_count | (literal_count << 16);
+    }
+
+    // Making room for the delta: it's always stored in one piece, so it might start over from the beginning of the buffer
+    // (the deltas left behind, at the end of the buffer, are the oldest ones, and they'd be overwritten out of the order by the next round)...
+    if(rewind->buffer_write + length > rewind->buffer_capacity) {
+        while(rewind->record_count > 0 && rewind->records[rewind->record_first].offset >= rewind->buffer_write) {
+            rewindDropOldest(rewind);
+        }
+
+        rewind->buffer_write = 0;
+    }
+
+    if(rewind->record_count == REWIND_RECORD_CAPACITY) {
+        rewindDropOldest(rewind);
+    }
+
+    // ... and the oldest deltas in its way are dropped (the records are in the order of the buffer, so they're always the oldest ones)
+    while(rewind->record_count > 0) {
+        RewindRecord* oldest = &rewind->records[rewind->record_first];
+
+        if(oldest->offset >= rewind->buffer_write + length || oldest->offset + oldest->length <= rewind->buffer_write) {
+            break;
+        }
+
+        rewindDropOldest(rewind);
+    }
+
+    memcpy(rewind->buffer + rewind->buffer_write, rewind->scratch, length * sizeof(uint32_t));
+
+    rewind->records[(rewind->record_first + rewind->record_count) % REWIND_RECORD_CAPACITY] = (RewindRecord) {
+        .offset = rewind->buffer_write,
+        .length = length
+    };
+
+    rewind->record_count++;
+    rewind->buffer_write += length;
+    rewind->buffer_used += length;
+
+    double cost = (GetTime() - start) * 1000000.0;
+    rewind->push_cost = rewind->push_cost > 0.0 ? rewind->push_cost + (cost - rewind->push_cost) * REWIND_COST_SMOOTHING : cost;
+    rewind->push_cost_max = fmax(rewind->push_cost_max, cost);
+}
+
+bool rewindStep(Rewind* rewind) {
+    if(!rewind || rewind->record_count == 0) {
+        return false;
+    }
+
+    // Applying the newest delta to the 'last' turns it into the state of the tick before it
+    RewindRecord* record = &rewind->records[(rewind->record_first + rewind->record_count - 1) % REWIND_RECORD_CAPACITY];
+    const uint32_t* delta = rewind->buffer + record->offset;
+    uint32_t* last = (uint32_t*) &rewind->last;
+    int word = 0;
+
+    for(int i = 0; i < record->length; ) {
+        uint32_t header = delta[i++];
+        uint32_t literal_count = header >> 16;
+
+        word += header & 0xFFFF;
+
+        for(uint32_t literal = 0; literal < literal_count; literal++) {
+            last[word++] ^= delta[i++];
+        }
+    }
+
+    // (The newest delta is always at the end of the written part of the buffer, so its space is free again)
+    rewind->buffer_write = record->offset;
+    rewind->buffer_used -= record->length;
+    rewind->record_count--;
+
+    return true;
+}
+
+bool rewindUpdate(Rewind* rewind) {
+    if(!rewind) {
+        return false;
+    }
+
+    if(!IsKeyDown(REWIND_KEY)) {
+        rewind->step_accumulator = 0.0f;
+        return false;
+    }
+
+    // The rewind runs at the 'REWIND_SPEED' times the tick rate, whatever the frame rate is.
+    // The simulation is restored only once, from the last of the steps (nothing in between would be shown anyway).
+    rewind->step_accumulator += GetFrameTime() * SIMULATION_TICK_RATE * REWIND_SPEED;
+
+    int step_count = (int) rewind->step_accumulator;
+    bool stepped = false;
+
+    rewind->step_accumulator -= step_count;
+
+    for(int step = 0; step < step_count && rewindStep(rewind); step++) {
+        stepped = true;
+    }
+
+    if(stepped) {
+        simulationRestore(&rewind->last);
+    }
+
+    // (Nothing is simulated while the key is held, even when there's no history left)
+    return true;
+}
+
+internal void rewindDropOldest(Rewind* rewind) {
+    rewind->buffer_used -= rewind->records[rewind->record_first].length;
+    rewind->record_first = (rewind->record_first + 1) % REWIND_RECORD_CAPACITY;
+    rewind->record_count--;
+}
+
+void rewindUnload(Rewind* rewind) {
+    if(!rewind) {
+        return;
+    }
+
+    MemFree(rewind->buffer);
+    MemFree(rewind->scratch);
+
+    rewind->buffer = NULL;
+    rewind->scratch = NULL;
+}
+
+Background backgroundInit() {
+    Background result = { 0 };
+
+    backgroundAddLayer(&result, GlobalState.Resources.texture_background, 1.0f, WHITE);
+
+    return result;
+}
+
+bool backgroundAddLayer(Background* background, Texture2D texture, float scroll_factor, Color tint) {
+    if(!background || background->layer_count >= BACKGROUND_LAYER_CAPACITY) {
+        return false;
+    }
+
+    background->layers[background->layer_count++] = (BackgroundLayer) {
+        .texture = texture,
+        .tint = tint,
+        .scroll_factor = scroll_factor,
+        .uv_offset = 0.0f
+    };
+
+    return true;
+}
+
+void backgroundUpdate(Background* background) {
+    if(!background) {
+        return;
+    }
+
+    // The left edge of the visible world (in the real position, so the shifts of the floating origin don't move the layers)
+    double camera_left = GlobalState.simulation.origin_x + GlobalState.simulation.camera.target.x - GlobalState.simulation.camera.offset.x;
+
+    for(int i = 0; i < background->layer_count; i++) {
+        BackgroundLayer* layer = &background->layers[i];
+
+        // Every layer covers the whole screen, so one repetition of the texture is exactly one screen width.
+        // 'fmod' keeps the offset small, no matter how far the camera has travelled.
+        // (It keeps the sign too, so the offset left of the world's start is moved into the '[0, width)')
+        float layer_scroll = fmod(camera_left * layer->scroll_factor, worldGetSize().x);
+
+        if(layer_scroll < 0.0f) {
+            layer_scroll += worldGetSize().x;
+        }
+
+        layer->uv_offset = layer_scroll * (layer->texture.width / worldGetSize().x);
+    }
+}
+
+void backgroundUpdateJob(void* data) {
+    backgroundUpdate((Background*) data);
+}
+
+void backgroundRender(Background* background) {
+    if(!background) {
+        return;
+    }
+
+    RenderVisibility* visibility = &GlobalState.visibility;
+    Rectangle view = visibility->bounds;
+
+    for(int i = 0; i < background->layer_count; i++) {
+        BackgroundLayer* layer = &background->layers[i];
+
+        // Only the open part of every corridor strip is drawn, the walls are covering the rest anyway
+        for(int strip_index = 0; strip_index < visibility->strip_count; strip_index++) {
+            CorridorStrip* strip = &visibility->strips[strip_index];
+
+            float left = fmaxf(strip->x, view.x);
+            float right = fminf(strip->x + strip->width, view.x + view.width);
+            float top = fmaxf(strip->ceiling_min - RENDER_STRIP_MARGIN, view.y);
+            float bottom = fminf(strip->floor_max + RENDER_STRIP_MARGIN, view.y + view.height);
+
+            if(right > left && bottom > top) {
+                backgroundRenderLayerRect(layer, view, (Rectangle) { left, top, right - left, bottom - top });
+            }
+        }
+    }
+}
+
+internal void backgroundRenderLayerRect(BackgroundLayer* layer, Rectangle view, Rectangle destination) {
+    // Every layer covers the whole 'view' (a single repetition of the texture is exactly one view), so the destination maps straight to the texture pixels
+    Vector2 texels_per_unit = { layer->texture.width / view.width, layer->texture.height / view.height };
+
+    Rectangle source = {
+        layer->uv_offset + (destination.x - view.x) * texels_per_unit.x,
+        (destination.y - view.y) * texels_per_unit.y,
+        destination.width * texels_per_unit.x,
+        destination.height * texels_per_unit.y
+    };
+
+#if defined(__EMSCRIPTEN__)
+    // WebGL 1 can't wrap the NPOT textures, so the rectangle is split at the texture seam into two quads.
+    // They're still covering every pixel of the destination exactly once.
+    source.x = fmodf(source.x, layer->texture.width);
+
+    if(source.x < 0.0f) {
+        source.x += layer->texture.width;
+    }
+
+    if(source.x + source.width > layer->texture.width) {
+        float seam = (layer->texture.width - source.x) / texels_per_unit.x;
+
+        DrawTexturePro(
+            layer->texture, 
+            (Rectangle) { source.x, source.y, layer->texture.width - source.x, source.height }, 
+            (Rectangle) { destination.x, destination.y, seam, destination.height }, 
+            Vector2Zero(), 
+            0.0f, 
+            layer->tint
+        );
+
+        DrawTexturePro(
+            layer->texture, 
+            (Rectangle) { 0.0f, source.y, source.width - (layer->texture.width - source.x), source.height }, 
+            (Rectangle) { destination.x + seam, destination.y, destination.width - seam, destination.height }, 
+            Vector2Zero(), 
+            0.0f, 
+            layer->tint
+        );
+
+        return;
+    }
+#endif
+
+    DrawTexturePro(layer->texture, source, destination, Vector2Zero(), 0.0f, layer->tint);
+}
+
+// Corridor's fragment shader (the vertex shader is the raylib's default one).
+// The quad spans the whole corridor and 'fragTexCoord' goes from 0.0 to 1.0 across it, so the world position is derived from the 'corridorRect'.
+// The positions are relative to the corridor's start, so the precision doesn't depend on how far we've travelled.
+internal const char* CORRIDOR_FRAGMENT_SHADER = 
+    SHADER_GLSL_HEADER
+    "#define OBSTACLE_COUNT " STRINGIFY_VALUE(OBSTACLE_CAPACITY) "\n"
+    "#define OBSTACLE_WIDTH " STRINGIFY_VALUE(OBSTACLE_WIDTH) ".0\n"
+    "#define LINE_HALF_THICKNESS (" STRINGIFY_VALUE(OBSTACLE_LINE_THICKNESS) ".0 * 0.5)\n"
+    "IN vec2 fragTexCoord;\n"
+    "uniform vec4 corridorRect;\n"                  // x, y, width, height (world units)
+    "uniform vec3 obstacles[OBSTACLE_COUNT];\n"     // x (relative to the corridor's start), point0.y, point1.y
+    "uniform vec4 colors[5];\n"                     // upper top, upper, lower, lower bottom, lines
+    "void main() {\n"
+    "    vec2 position = fragTexCoord * corridorRect.zw;\n"
+    // Picking the segment (GLSL ES 1.00 can index the uniform arrays only with the loop index)
+    "    vec3 a = obstacles[0];\n"
+    "    vec3 b = obstacles[1];\n"
+    "    for(int i = 1; i < OBSTACLE_COUNT - 1; i++) {\n"
+    "        if(position.x >= obstacles[i].x) { a = obstacles[i]; b = obstacles[i + 1]; }\n"
+    "    }\n"
+    // The handles are horizontal and half of the segment long, so 'x(t) = a.x + W * (1.5t - 1.5t^2 + t^3)'.
+    // It's monotonic, so a few Newton's steps find the 't' of this fragment.
+    "    float u = clamp((position.x - a.x) / OBSTACLE_WIDTH, 0.0, 1.0);\n"
+    "    float t = u;\n"
+    "    for(int i = 0; i < 4; i++) {\n"
+    "        float f = t * (1.5 - 1.5 * t + t * t) - u;\n"
+    "        t = clamp(t - f / (1.5 - 3.0 * t + 3.0 * t * t), 0.0, 1.0);\n"
+    "    }\n"
+    // ... and the 'y' is just a smooth-step in between the two obstacles
+    "    float s = t * t * (3.0 - 2.0 * t);\n"
+    "    float slope = 6.0 * t * (1.0 - t) / (OBSTACLE_WIDTH * (1.5 - 3.0 * t + 3.0 * t * t));\n"
+    "    float upper = mix(a.y, b.y, s);\n"
+    "    float lower = mix(a.z, b.z, s);\n"
+    "    vec4 color = vec4(0.0);\n"
+    "    if(position.y < upper) {\n"
+    "        color = mix(colors[0], colors[1], position.y / upper);\n"
+    "    } else if(position.y > lower) {\n"
+    "        color = mix(colors[2], colors[3], (position.y - lower) / (corridorRect.w - lower));\n"
+    "    }\n"
+    // Outlines: the vertical distance to the wall, corrected by the wall's slope
+    "    float slope0 = (b.y - a.y) * slope;\n"
+    "    float slope1 = (b.z - a.z) * slope;\n"
+    "    float distance0 = abs(position.y - upper) / sqrt(1.0 + slope0 * slope0);\n"
+    "    float distance1 = abs(position.y - lower) / sqrt(1.0 + slope1 * slope1);\n"
+    "    float line = 1.0 - smoothstep(LINE_HALF_THICKNESS - 0.5, LINE_HALF_THICKNESS + 0.5, min(distance0, distance1));\n"
+    "    FRAG_COLOR = mix(color, colors[4], line);\n"
+    "}\n";
+
+CorridorRenderer corridorRendererInit() {
+    CorridorRenderer result = { 0 };
+
+    result.shader = LoadShaderFromMemory(NULL, CORRIDOR_FRAGMENT_SHADER);
+
+    result.ready = renderShaderIsReady(result.shader);
+
+    if(!result.ready) {
+        TraceLog(LOG_WARNING, "CORRIDOR: Shader renderer is not available, using the CPU renderer");
+        return result;
+    }
+
+    result.location_rect = GetShaderLocation(result.shader, "corridorRect");
+    result.location_obstacles = GetShaderLocation(result.shader, "obstacles");
+    result.location_colors = GetShaderLocation(result.shader, "colors");
+
+    Vector4 colors[5] = {
+        ColorNormalize(GetColor(OBSTACLE_UPPER_COLOR_TOP)),
+        ColorNormalize(GetColor(OBSTACLE_UPPER_COLOR)),
+        ColorNormalize(GetColor(OBSTACLE_LOWER_COLOR)),
+        ColorNormalize(GetColor(OBSTACLE_LOWER_COLOR_BOTTOM)),
+        ColorNormalize(GetColor(GAME_LINES_COLOR))
+    };
+
+    SetShaderValueV(result.shader, result.location_colors, colors, SHADER_UNIFORM_VEC4, 5);
+
+    return result;
+}
+
+void corridorRendererRender(CorridorRenderer* renderer) {
+    ObstacleList* obstacle_list = &GlobalState.simulation.obstacle_list;
+
+    Rectangle corridor_rect = {
+        obstacle_list->list[0].position.x,
+        0.0f,
+        obstacle_list->list[OBSTACLE_CAPACITY - 1].position.x - obstacle_list->list[0].position.x,
+        worldGetSize().y + 1
+    };
+
+    Vector3 obstacles[OBSTACLE_CAPACITY] = { 0 };
+
+    for(int i = 0; i < OBSTACLE_CAPACITY; i++) {
+        obstacles[i] = (Vector3) {
+            obstacle_list->list[i].position.x - corridor_rect.x,
+            obstacle_list->list[i].point0.y,
+            obstacle_list->list[i].point1.y
+        };
+    }
+
+    SetShaderValue(renderer->shader, renderer->location_rect, &corridor_rect, SHADER_UNIFORM_VEC4);
+    SetShaderValueV(renderer->shader, renderer->location_obstacles, obstacles, SHADER_UNIFORM_VEC3, OBSTACLE_CAPACITY);
+
+    // raylib's default 1x1 white texture, so the 'fragTexCoord' goes from 0.0 to 1.0 across the quad
+    Texture2D texture = { rlGetTextureIdDefault(), 1, 1, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+
+    // Only the wall parts of the visible strips are drawn (the 'corridorRect' uniform stays the same, so the shader doesn't notice).
+    // Every covered pixel runs the whole spline inversion, so neither the off-screen corridor nor the open water is shaded.
+    RenderVisibility* visibility = &GlobalState.visibility;
+
+    // (The overdraw view counts the fragments with its own shader)
+    bool shader_override = GlobalState.Debug.overdraw_view.active;
+
+    if(!shader_override) {
+        BeginShaderMode(renderer->shader);
+    }
+
+        for(int i = 0; i < visibility->strip_count; i++) {
+            CorridorStrip* strip = &visibility->strips[i];
+
+            if(!strip->has_walls) {
+                continue;
+            }
+
+            float ceiling_bottom = strip->ceiling_max + RENDER_STRIP_MARGIN;
+            float floor_top = strip->floor_min - RENDER_STRIP_MARGIN;
+
+            // The walls are overlapping in the narrow parts of the corridor, so they're merged into a single quad
+            Rectangle parts[2] = {
+                { strip->x, corridor_rect.y, strip->width, ceiling_bottom - corridor_rect.y },
+                { strip->x, floor_top, strip->width, corridor_rect.y + corridor_rect.height - floor_top }
+            };
+            int part_count = 2;
+
+            if(floor_top <= ceiling_bottom) {
+                parts[0].height = corridor_rect.height;
+                part_count = 1;
+            }
+
+            for(int part = 0; part < part_count; part++) {
+                Rectangle destination = parts[part];
+                Rectangle source = {
+                    (destination.x - corridor_rect.x) / corridor_rect.width,
+                    (destination.y - corridor_rect.y) / corridor_rect.height,
+                    destination.width / corridor_rect.width,
+                    destination.height / corridor_rect.height
+                };
+
+                DrawTexturePro(texture, source, destination, Vector2Zero(), 0.0f, WHITE);
+            }
+        }
+
+    if(!shader_override) {
+        EndShaderMode();
+    }
+}
+
+void corridorRendererUnload(CorridorRenderer* renderer) {
+    if(renderer->ready) {
+        UnloadShader(renderer->shader);
+    }
+
+    *renderer = (CorridorRenderer) { 0 };
+}
+
+// Overdraw counting shader: every shaded fragment adds one step to the red channel (the blending is additive)
+internal const char* OVERDRAW_COUNT_FRAGMENT_SHADER = 
+    SHADER_GLSL_HEADER
+    "void main() {\n"
+    "    FRAG_COLOR = vec4(" STRINGIFY_VALUE(OVERDRAW_COUNT_STEP) ".0 / 255.0, 0.0, 0.0, 1.0);\n"
+    "}\n";
+
+// Overdraw heat-map shader: turns the counted layers back into a number and picks its color
+internal const char* OVERDRAW_HEATMAP_FRAGMENT_SHADER = 
+    SHADER_GLSL_HEADER
+    "#define LEVELS " STRINGIFY_VALUE(OVERDRAW_HEATMAP_LEVELS) "\n"
+    "IN vec2 fragTexCoord;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colors[LEVELS];\n"
+    "void main() {\n"
+    "    float count = floor(TEXTURE(texture0, fragTexCoord).r * 255.0 / " STRINGIFY_VALUE(OVERDRAW_COUNT_STEP) ".0 + 0.5);\n"
+    "    vec4 color = colors[0];\n"
+    "    for(int i = 1; i < LEVELS; i++) {\n"
+    "        if(count >= float(i)) { color = colors[i]; }\n"
+    "    }\n"
+    "    FRAG_COLOR = color;\n"
+    "}\n";
+
+OverdrawView overdrawViewInit() {
+    OverdrawView result = { 0 };
+
+    result.shader_count = LoadShaderFromMemory(NULL, OVERDRAW_COUNT_FRAGMENT_SHADER);
+    result.shader_heatmap = LoadShaderFromMemory(NULL, OVERDRAW_HEATMAP_FRAGMENT_SHADER);
+
+    result.ready = renderShaderIsReady(result.shader_count) && renderShaderIsReady(result.shader_heatmap);
+
+    if(!result.ready) {
+        TraceLog(LOG_WARNING, "OVERDRAW: Heat-map view is not available");
+        return result;
+    }
+
+    unsigned int heatmap_colors[OVERDRAW_HEATMAP_LEVELS] = OVERDRAW_HEATMAP_COLORS;
+    Vector4 colors[OVERDRAW_HEATMAP_LEVELS] = { 0 };
+
+    for(int i = 0; i < OVERDRAW_HEATMAP_LEVELS; i++) {
+        colors[i] = ColorNormalize(GetColor(heatmap_colors[i]));
+    }
+
+    result.location_colors = GetShaderLocation(result.shader_heatmap, "colors");
+    SetShaderValueV(result.shader_heatmap, result.location_colors, colors, SHADER_UNIFORM_VEC4, OVERDRAW_HEATMAP_LEVELS);
+
+    return result;
+}
+
+void overdrawViewUpdate(OverdrawView* view) {
+    if(!view || !view->ready) {
+        return;
+    }
+
+    renderTextureFit(&view->target, renderGetSize().x, renderGetSize().y, TEXTURE_FILTER_POINT, TEXTURE_WRAP_REPEAT);
+
+    // The same world render, but every draw call is counting instead of shading
+    BeginTextureMode(view->target);
+    ClearBackground(BLANK);
+    BeginShaderMode(view->shader_count);
+    BeginBlendMode(BLEND_ADDITIVE);
+
+        view->active = true;
+        renderWorld();
+        view->active = false;
+
+    EndBlendMode();
+    EndShaderMode();
+    EndTextureMode();
+}
+
+void overdrawViewRender(OverdrawView* view) {
+    if(!view || !view->ready) {
+        return;
+    }
+
+    BeginShaderMode(view->shader_heatmap);
+
+        renderTextureBlit(view->target.texture, (Rectangle) { 0.0f, 0.0f, view->target.texture.width, view->target.texture.height });
+
+    EndShaderMode();
+}
+
+void overdrawViewUnload(OverdrawView* view) {
+    if(view->target.id > 0) {
+        UnloadRenderTexture(view->target);
+    }
+
+    if(view->ready) {
+        UnloadShader(view->shader_count);
+        UnloadShader(view->shader_heatmap);
+    }
+
+    *view = (OverdrawView) { 0 };
+}
+
+FrameScheduler frameSchedulerInit() {
+    return (FrameScheduler) {
+        .target_fps = -1,
+        .wake_time = SCHEDULER_WAKE_TIME,
+        .waiting_events = false
+    };
+}
+
+void frameSchedulerUpdate(FrameScheduler* scheduler) {
+    if(!scheduler) {
+        return;
+    }
+
+    // (The autopilot plays in the hidden, unfocused window, so it's always treated as the visible and the focused one)
+    // (The running gameplay never blocks, it only drops to the low tick rate below)
+    bool window_hidden = !GlobalState.autopilot.active && stateMachineIsStatic() && (IsWindowHidden() || IsWindowMinimized());
+    bool window_focused = GlobalState.autopilot.active || IsWindowFocused();
+
+    // Hidden window: there's nothing to show and nothing to hear, so we're blocking until the window receives an event.
+    // (The music is paused, otherwise its stream would run dry in between the events)
+    if(window_hidden != scheduler->waiting_events) {
+        if(window_hidden) {
+            EnableEventWaiting();
+            PauseMusicStream(GlobalState.Resources.music_background);
+        } else {
+            DisableEventWaiting();
+            ResumeMusicStream(GlobalState.Resources.music_background);
+        }
+
+        scheduler->waiting_events = window_hidden;
+    }
+
+    if(frameSchedulerInputActive()) {
+        scheduler->wake_time = SCHEDULER_WAKE_TIME;
+    } else {
+        scheduler->wake_time -= GetFrameTime();
+    }
+
+    // Static screen, unfocused or minimized window: the low tick rate is enough, unless the player has just touched something
+    // (The low-latency mode runs without the V-Sync, so its full rate is the raylib's frame limiter at the monitor's refresh rate)
+    int target_fps = GlobalState.Game.low_latency ? inputGetLowLatencyFps() : SCHEDULER_FULL_FPS;
+
+    bool window_visible = GlobalState.autopilot.active || (!IsWindowHidden() && !IsWindowMinimized());
+
+    if(!window_hidden && scheduler->wake_time <= 0.0f && (!window_focused || !window_visible || stateMachineIsStatic())) {
+        target_fps = SCHEDULER_IDLE_FPS;
+    }
+
+    // (The simulated frame time of the autopilot doesn't depend on the real one, so there's no reason to wait)
+    if(GlobalState.autopilot.frame_time > 0.0f) {
+        target_fps = 0;
+    }
+
+    if(target_fps != scheduler->target_fps) {
+        SetTargetFPS(target_fps);
+        scheduler->target_fps = target_fps;
+    }
+}
+
+bool frameSchedulerIsFullRate(FrameScheduler* scheduler) {
+    return scheduler->target_fps != SCHEDULER_IDLE_FPS && !scheduler->waiting_events;
+}
+
+bool frameSchedulerInputActive() {
+    // 'GetKeyPressed' would consume the key from the raylib's queue, so we're checking only the non-destructive states
+    Vector2 mouse_delta = GetMouseDelta();
+
+    return playerInputGetDown() ||
+        IsKeyDown(KEY_ESCAPE) || 
+        IsKeyDown(KEY_ENTER) ||
+        IsMouseButtonDown(MOUSE_BUTTON_RIGHT) ||
+        mouse_delta.x != 0.0f || 
+        mouse_delta.y != 0.0f;
+}
+
+MemoryStats memoryStatsInit() {
+    return (MemoryStats) {
+        .snapshot = memoryTrackerGetStats(),
+        .snapshot_state = GlobalState.Game.gameplay_state_machine
+    };
+}
+
+void memoryStatsUpdate(MemoryStats* stats) {
+    if(!stats) {
+        return;
+    }
+
+    MemoryTrackerStats snapshot = memoryTrackerGetStats();
+
+    stats->frame_allocations = snapshot.allocation_count - stats->snapshot.allocation_count;
+    stats->frame_bytes = snapshot.allocation_bytes - stats->snapshot.allocation_bytes;
+
+    // The previous frame is accounted to the state it has started in (the transitions happen in the middle of the frame)
+    stats->state_allocations[stats->snapshot_state] += stats->frame_allocations;
+    stats->state_bytes[stats->snapshot_state] += stats->frame_bytes;
+    stats->state_frames[stats->snapshot_state]++;
+
+    stats->snapshot = snapshot;
+    stats->snapshot_state = GlobalState.Game.gameplay_state_machine;
+}
+
+FrameArena frameArenaInit(size_t capacity) {
+    FrameArena result = { 0 };
+
+    result.memory = MemAlloc(capacity);
+
+    if(!result.memory) {
+        TraceLog(LOG_ERROR, "ARENA: Failed to allocate the frame arena (%i bytes)", (int) capacity);
+        return result;
+    }
+
+    result.capacity = capacity;
+    return result;
+}
+
+void frameArenaReset(FrameArena* arena) {
+    if(!arena) {
+        return;
+    }
+
+    arena->used_last = arena->used;
+    arena->used = 0;
+    arena->requested = 0;
+}
+
+void* frameArenaPush(FrameArena* arena, size_t size) {
+    // Every allocation starts at the aligned offset (the arena's block itself comes aligned from the allocator)
+    size_t offset = (arena->used + FRAME_ARENA_ALIGNMENT - 1) & ~((size_t) FRAME_ARENA_ALIGNMENT - 1);
+
+    // The high-water mark counts the requests that didn't fit as well, so it tells how big the arena should be
+    arena->requested += offset - arena->used + size;
+
+    bool peak = arena->requested > arena->high_water;
+
+    if(peak) {
+        arena->high_water = arena->requested;
+    }
+
+    // (Reported only on the new peaks, not on every frame that runs out)
+    if(offset + size > arena->capacity) {
+        if(peak) {
+            TraceLog(LOG_WARNING, "ARENA: Frame arena is out of memory (%i bytes requested in this frame, the capacity is %i)", (int) arena->requested, (int) arena->capacity);
+        }
+
+        return NULL;
+    }
+
+    arena->used = offset + size;
+    return arena->memory + offset;
+}
+
+const char* frameArenaFormat(FrameArena* arena, const char* format, ...) {
+    va_list arguments;
+
+    // The first pass only measures the string, the second one writes it into the arena
+    va_start(arguments, format);
+    int length = vsnprintf(NULL, 0, format, arguments);
+    va_end(arguments);
+
+    char* result = length >= 0 ? frameArenaPush(arena, length + 1) : NULL;
+
+    if(!result) {
+        return "";
+    }
+
+    va_start(arguments, format);
+    vsnprintf(result, length + 1, format, arguments);
+    va_end(arguments);
+
+    return result;
+}
+
+void frameArenaUnload(FrameArena* arena) {
+    if(!arena || !arena->memory) {
+        return;
+    }
+
+    MemFree(arena->memory);
+    *arena = (FrameArena) { 0 };
+}
+
+Autopilot autopilotInit(int gameplay_frames_limit) {
+    return (Autopilot) {
+        .active = true,
+        .gameplay_frames_limit = gameplay_frames_limit
+    };
+}
+
+void autopilotUpdate(Autopilot* autopilot) {
+    if(!autopilot || !autopilot->active) {
+        return;
+    }
+
+    autopilot->down_prev = autopilot->down;
+
+    if(GlobalState.Game.gameplay_state_machine != STATE_GAMEPLAY) {
+        // Tapping the button gets us through the start and the game-over screens
+        autopilot->down = !autopilot->down_prev;
+        autopilot->game_frames = 0;
+        return;
+    }
+
+    // Holding the button while the extrapolated height is below the middle of the corridor ahead
+    // (The 'y' grows downwards, and the player's velocity is applied once per frame)
+    Player* player = &GlobalState.simulation.player;
+    float ahead = player->position.x + AUTOPILOT_LOOKAHEAD;
+    float corridor_top = 0.0f;
+    float corridor_bottom = worldGetSize().y;
+
+    obstacleListGetCorridor(ahead, ahead + OBSTACLE_HEIGHTFIELD_STEP, &corridor_top, &corridor_bottom);
+
+    float height = player->position.y + player->velocity.y * AUTOPILOT_REACTION;
+    autopilot->down = height > (corridor_top + corridor_bottom) / 2.0f;
+
+    if(autopilot->give_up_frames_max > 0) {
+        if(autopilot->game_frames == 0) {
+            autopilot->give_up_frame = randomGetValue(&autopilot->random, autopilot->give_up_frames_min, autopilot->give_up_frames_max);
+        }
+
+        if(autopilot->game_frames++ >= autopilot->give_up_frame) {
+            autopilot->down = false;
+        }
+    }
+
+    autopilot->gameplay_frames++;
+
+    if(autopilot->gameplay_frames_limit > 0 && autopilot->gameplay_frames >= autopilot->gameplay_frames_limit) {
+        GlobalState.Game.quit = true;
+    }
+}
+
+InputQueue inputQueueInit() {
+    return (InputQueue) {
+        .poll_time = GetTime()
+    };
+}
+
+void inputQueuePoll(InputQueue* queue) {
+    if(!queue) {
+        return;
+    }
+
+    double poll_time = GetTime();
+    bool down = playerInputGetDown();
+
+    if(down != queue->down) {
+        // (The event arrived somewhere in between the two polls)
+        InputEvent event = {
+            .time = (queue->poll_time + poll_time) / 2.0,
+            .down = down
+        };
+
+        // Nobody's consuming the events outside of the gameplay, so the oldest one makes place (only its state is kept)
+        if(queue->event_count == INPUT_QUEUE_CAPACITY) {
+            queue->consumed_down = queue->events[queue->event_first].down;
+            queue->event_first = (queue->event_first + 1) % INPUT_QUEUE_CAPACITY;
+            queue->event_count--;
+        }
+
+        queue->events[(queue->event_first + queue->event_count) % INPUT_QUEUE_CAPACITY] = event;
+        queue->event_count++;
+        queue->down = down;
+
+        if(queue->pending_count < INPUT_QUEUE_CAPACITY) {
+            queue->pending[queue->pending_count++] = event.time;
+        }
+    }
+
+    queue->poll_time = poll_time;
+}
+
+float inputQueueConsume(InputQueue* queue, double start, double end) {
+    // Walking through the events of the step in their order and summing up the time in between them while the button is down
+    double held_time = 0.0;
+    double cursor = start;
+    bool down = queue->consumed_down;
+
+    while(queue->event_count > 0) {
+        InputEvent* event = &queue->events[queue->event_first];
+
+        if(event->time > end) {
+            break;
+        }
+
+        // (The events from before the step only tell us the state at its start)
+        if(event->time > cursor) {
+            held_time += down ? event->time - cursor : 0.0;
+            cursor = event->time;
+        }
+
+        down = event->down;
+        queue->event_first = (queue->event_first + 1) % INPUT_QUEUE_CAPACITY;
+        queue->event_count--;
+    }
+
+    if(down && end > cursor) {
+        held_time += end - cursor;
+    }
+
+    queue->consumed_down = down;
+    return held_time;
+}
+
+void inputQueuePresent(InputQueue* queue, double present_time) {
+    if(!queue) {
+        return;
+    }
+
+    for(int i = 0; i < queue->pending_count; i++) {
+        queue->latencies[queue->latency_count % INPUT_LATENCY_CAPACITY] = (present_time - queue->pending[i]) * 1000.0;
+        queue->latency_count++;
+    }
+
+    queue->pending_count = 0;
+}
+
+void inputQueueResetLatency(InputQueue* queue) {
+    queue->pending_count = 0;
+    queue->latency_count = 0;
+}
+
+InputLatencyReport inputQueueGetLatency(InputQueue* queue, FrameArena* arena) {
+    InputLatencyReport result = { 0 };
+
+    int count = queue->latency_count < INPUT_LATENCY_CAPACITY ? queue->latency_count : INPUT_LATENCY_CAPACITY;
+    float* sorted = count > 0 ? frameArenaPush(arena, sizeof(float) * count) : NULL;
+
+    if(!sorted) {
+        return result;
+    }
+
+    // (A plain insertion sort: there are only a few hundred of them, and the libc's 'qsort' is allowed to allocate)
+    for(int i = 0; i < count; i++) {
+        float latency = queue->latencies[i];
+        int j = i;
+
+        for(; j > 0 && sorted[j - 1] > latency; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+
+        sorted[j] = latency;
+    }
+
+    result.p50 = sorted[(int) (count * 0.50f)];
+    result.p95 = sorted[(int) (count * 0.95f)];
+    result.p99 = sorted[(int) (count * 0.99f)];
+    result.count = count;
+
+    return result;
+}
+
+void inputSetLowLatency(bool low_latency) {
+    // The swap of the V-Sync mode waits for the vertical blank, and the driver can queue up the frames in front of it.
+    // In the low-latency mode the swap returns right away, and the raylib's frame limiter waits *before* the input polling
+    // (check the 'EndDrawing'), so the simulation always starts with the freshest input (the price is the tearing).
+    if(low_latency) {
+        ClearWindowState(FLAG_VSYNC_HINT);
+    } else {
+        SetWindowState(FLAG_VSYNC_HINT);
+    }
+
+    // (The frame scheduler applies the new frame limit)
+    GlobalState.Game.frame_scheduler.target_fps = -1;
+}
+
+int inputGetLowLatencyFps() {
+    int refresh_rate = GetMonitorRefreshRate(GetCurrentMonitor());
+    return refresh_rate > 0 ? refresh_rate : INPUT_LOW_LATENCY_FPS;
+}
+
+RenderScaler renderScalerInit() {
+    return (RenderScaler) {
+        .level = 0,
+
+        .frame_time_average = 1.0f / RENDER_SCALE_TARGET_FPS,
+        .cooldown = RENDER_SCALE_COOLDOWN,
+        .headroom_time = 0.0f,
+        .recovery_delay = RENDER_SCALE_RECOVERY_DELAY,
+        .time_since_upgrade = 0.0f
+    };
+}
+
+void renderScalerUpdate(RenderScaler* render_scaler) {
+    if(!render_scaler) {
+        return;
+    }
+
+    const float FRAME_TIME_TARGET = 1.0f / RENDER_SCALE_TARGET_FPS;
+
+    // Single long frames (window dragging, resource loading) shouldn't throw the average around
+    float frame_time = Clamp(GetFrameTime(), 0.0f, FRAME_TIME_TARGET * 4.0f);
+
+    render_scaler->frame_time_average = Lerp(render_scaler->frame_time_average, frame_time, RENDER_SCALE_SMOOTHING);
+    render_scaler->cooldown -= frame_time;
+    render_scaler->time_since_upgrade += frame_time;
+
+    if(render_scaler->cooldown > 0.0f) {
+        return;
+    }
+
+    if(render_scaler->frame_time_average > FRAME_TIME_TARGET * RENDER_SCALE_OVERLOAD) {
+        render_scaler->headroom_time = 0.0f;
+
+        if(render_scaler->level + 1 >= RENDER_SCALE_LEVEL_COUNT) {
+            return;
+        }
+
+        // If the last upgrade didn't hold for long, we're waiting longer before the next try (hysteresis)
+        render_scaler->recovery_delay = render_scaler->time_since_upgrade < render_scaler->recovery_delay ?
+            Clamp(render_scaler->recovery_delay * 2.0f, RENDER_SCALE_RECOVERY_DELAY, RENDER_SCALE_RECOVERY_DELAY_MAX) :
+            RENDER_SCALE_RECOVERY_DELAY;
+
+        render_scaler->level++;
+        render_scaler->cooldown = RENDER_SCALE_COOLDOWN;
+    } else if(render_scaler->frame_time_average < FRAME_TIME_TARGET * RENDER_SCALE_HEADROOM) {
+        render_scaler->headroom_time += frame_time;
+
+        if(render_scaler->level <= 0 || render_scaler->headroom_time < render_scaler->recovery_delay) {
+            return;
+        }
+
+        render_scaler->level--;
+        render_scaler->cooldown = RENDER_SCALE_COOLDOWN;
+        render_scaler->headroom_time = 0.0f;
+        render_scaler->time_since_upgrade = 0.0f;
+    } else {
+        render_scaler->headroom_time = 0.0f;
+    }
+}
+
+float renderScalerGetScale(RenderScaler* render_scaler) {
+    const float levels[RENDER_SCALE_LEVEL_COUNT] = RENDER_SCALE_LEVELS;
+
+    return levels[render_scaler->level];
+}
+
+// FXAA fragment shader (the vertex shader is the raylib's default one).
+// The popular single-pass variant: the edge direction comes from the luma of the 4 diagonal neighbours,
+// and the texture is then sampled along the edge (the result is rejected if it leaves the local luma range).
+internal const char* FXAA_FRAGMENT_SHADER = 
+    SHADER_GLSL_HEADER
+    "#define SPAN_MAX " STRINGIFY_VALUE(FXAA_SPAN_MAX) "\n"
+    "#define REDUCE_MUL " STRINGIFY_VALUE(FXAA_REDUCE_MUL) "\n"
+    "#define REDUCE_MIN " STRINGIFY_VALUE(FXAA_REDUCE_MIN) "\n"
+    "IN vec2 fragTexCoord;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec2 texelSize;\n"
+    "void main() {\n"
+    "    vec3 luma = vec3(0.299, 0.587, 0.114);\n"
+    "    float lumaNW = dot(TEXTURE(texture0, fragTexCoord + vec2(-1.0, -1.0) * texelSize).rgb, luma);\n"
+    "    float lumaNE = dot(TEXTURE(texture0, fragTexCoord + vec2(1.0, -1.0) * texelSize).rgb, luma);\n"
+    "    float lumaSW = dot(TEXTURE(texture0, fragTexCoord + vec2(-1.0, 1.0) * texelSize).rgb, luma);\n"
+    "    float lumaSE = dot(TEXTURE(texture0, fragTexCoord + vec2(1.0, 1.0) * texelSize).rgb, luma);\n"
+    "    float lumaM = dot(TEXTURE(texture0, fragTexCoord).rgb, luma);\n"
+    "    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));\n"
+    "    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));\n"
+    "    vec2 direction = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));\n"
+    "    float directionReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * REDUCE_MUL, REDUCE_MIN);\n"
+    "    float directionScale = 1.0 / (min(abs(direction.x), abs(direction.y)) + directionReduce);\n"
+    "    direction = clamp(direction * directionScale, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * texelSize;\n"
+    "    vec3 colorA = 0.5 * (\n"
+    "        TEXTURE(texture0, fragTexCoord + direction * (1.0 / 3.0 - 0.5)).rgb +\n"
+    "        TEXTURE(texture0, fragTexCoord + direction * (2.0 / 3.0 - 0.5)).rgb);\n"
+    "    vec3 colorB = colorA * 0.5 + 0.25 * (\n"
+    "        TEXTURE(texture0, fragTexCoord + direction * -0.5).rgb +\n"
+    "        TEXTURE(texture0, fragTexCoord + direction * 0.5).rgb);\n"
+    "    float lumaB = dot(colorB, luma);\n"
+    "    FRAG_COLOR = vec4((lumaB < lumaMin || lumaB > lumaMax) ? colorA : colorB, 1.0);\n"
+    "}\n";
+
+AntiAliasing antiAliasingInit() {
+    AntiAliasing result = { 0 };
+
+    result.shader_fxaa = LoadShaderFromMemory(NULL, FXAA_FRAGMENT_SHADER);
+
+    result.ready = renderShaderIsReady(result.shader_fxaa);
+
+    if(!result.ready) {
+        TraceLog(LOG_WARNING, "ANTI-ALIASING: FXAA is not available");
+        result.mode = ANTI_ALIASING_NONE;
+
+        return result;
+    }
+
+    result.location_texel_size = GetShaderLocation(result.shader_fxaa, "texelSize");
+    result.mode = ANTI_ALIASING_DEFAULT;
+
+    return result;
+}
+
+void antiAliasingCycle(AntiAliasing* anti_aliasing) {
+    if(!anti_aliasing || !anti_aliasing->ready) {
+        return;
+    }
+
+    anti_aliasing->mode = (anti_aliasing->mode + 1) % ANTI_ALIASING_MODE_COUNT;
+}
+
+void antiAliasingRender(AntiAliasing* anti_aliasing, Texture2D texture, Rectangle destination) {
+    if(anti_aliasing->mode == ANTI_ALIASING_NONE) {
+        renderTextureBlit(texture, destination);
+        return;
+    }
+
+    // (The render texture gets resized by the render scaler, so the texel size is updated on every blit)
+    Vector2 texel_size = { 1.0f / texture.width, 1.0f / texture.height };
+    SetShaderValue(anti_aliasing->shader_fxaa, anti_aliasing->location_texel_size, &texel_size, SHADER_UNIFORM_VEC2);
+
+    BeginShaderMode(anti_aliasing->shader_fxaa);
+
+        renderTextureBlit(texture, destination);
+
+    EndShaderMode();
+}
+
+const char* antiAliasingGetName(AntiAliasing* anti_aliasing) {
+    switch (anti_aliasing->mode) {
+        case ANTI_ALIASING_NONE:        return "off";
+        case ANTI_ALIASING_FXAA:        return "FXAA";
+        default:                        return "unknown";
+    }
+}
+
+void antiAliasingUnload(AntiAliasing* anti_aliasing) {
+    if(anti_aliasing->ready) {
+        UnloadShader(anti_aliasing->shader_fxaa);
+    }
+
+    *anti_aliasing = (AntiAliasing) { 0 };
+}
+
+// Common part of the post-processing passes' shaders: 'world' is the position relative to the visible world (in world units),
+// 'pattern' is the same position, but horizontally offset by the camera position modulo the 'POST_PATTERN_PERIOD'.
+#define POST_PASS_SHADER_HEADER \
+    SHADER_GLSL_HEADER \
+    "#define TAU 6.2831853\n" \
+    "#define PERIOD " STRINGIFY_VALUE(POST_PATTERN_PERIOD) "\n" \
+    "IN vec2 fragTexCoord;\n" \
+    "uniform sampler2D texture0;\n" \
+    "uniform vec4 worldRect;\n" \
+    "uniform float time;\n" \
+    "float luma(vec3 color) { return dot(color, vec3(0.299, 0.587, 0.114)); }\n" \
+    "vec2 worldPosition() { return vec2(fragTexCoord.x, 1.0 - fragTexCoord.y) * worldRect.zw; }\n" \
+    "vec2 patternPosition() { return worldRect.xy + worldPosition(); }\n"
+
+// Fog: the deeper, the denser ('r' - fog amount, 'g' - guide for the bilateral upsample)
+internal const char* POST_FOG_FRAGMENT_SHADER = 
+    POST_PASS_SHADER_HEADER
+    "void main() {\n"
+    "    float depth = worldPosition().y / worldRect.w;\n"
+    "    float amount = 0.1 + 0.35 * smoothstep(0.2, 1.0, depth);\n"
+    "    FRAG_COLOR = vec4(amount, luma(TEXTURE(texture0, fragTexCoord).rgb), 0.0, 1.0);\n"
+    "}\n";
+
+// Refraction wobble: slow sine waves, stored as the offsets ('rg', 0.5 - no offset)
+internal const char* POST_WOBBLE_FRAGMENT_SHADER = 
+    POST_PASS_SHADER_HEADER
+    "void main() {\n"
+    "    vec2 position = patternPosition() * (TAU / PERIOD);\n"
+    "    vec2 offset = vec2(sin(position.y * 3.0 + time * 2.0), sin(position.x * 4.0 + time * 3.0));\n"
+    "    FRAG_COLOR = vec4(offset * 0.5 + 0.5, 0.0, 1.0);\n"
+    "}\n";
+
+// Caustics: three moving wave fronts, the light gathers where they cancel each other out.
+// The wave vectors are whole multiples of the 'TAU / PERIOD' and the speeds are whole numbers, so the pattern is periodic in both, space and time.
+// ('r' - light, 'g' - guide for the bilateral upsample)
+internal const char* POST_CAUSTICS_FRAGMENT_SHADER = 
+    POST_PASS_SHADER_HEADER
+    "float wave(vec2 position, vec2 direction, float speed) { return sin(dot(position, direction) * (TAU / PERIOD) + time * speed); }\n"
+    "void main() {\n"
+    "    vec2 position = patternPosition();\n"
+    "    float waves = wave(position, vec2(5.0, 3.0), 1.0) + wave(position, vec2(-4.0, 5.0), 2.0) + wave(position, vec2(2.0, -6.0), 3.0);\n"
+    "    float depth = worldPosition().y / worldRect.w;\n"
+    "    float light = pow(1.0 - abs(waves) / 3.0, 6.0) * (1.0 - clamp(depth, 0.0, 1.0));\n"
+    "    FRAG_COLOR = vec4(light, luma(TEXTURE(texture0, fragTexCoord).rgb), 0.0, 1.0);\n"
+    "}\n";
+
+// Bloom: a bright-pass of the blurred world, masked around the visible collectibles
+internal const char* POST_BLOOM_FRAGMENT_SHADER = 
+    POST_PASS_SHADER_HEADER
+    "#define COLLECTIBLE_COUNT " STRINGIFY_VALUE(OBSTACLE_CAPACITY) "\n"
+    "#define THRESHOLD 0.45\n"
+    "uniform vec3 collectibles[COLLECTIBLE_COUNT];\n"  // x, y (relative to the visible world), radius (0.0 - no collectible)
+    "uniform vec2 blurStep;\n"
+    "void main() {\n"
+    "    vec2 position = worldPosition();\n"
+    "    float mask = 0.0;\n"
+    "    for(int i = 0; i < COLLECTIBLE_COUNT; i++) {\n"
+    "        float radius = collectibles[i].z;\n"
+    "        if(radius > 0.0) { mask = max(mask, 1.0 - smoothstep(radius, radius * 3.0, distance(position, collectibles[i].xy))); }\n"
+    "    }\n"
+    "    vec3 color = vec3(0.0);\n"
+    "    for(int x = -1; x <= 1; x++) {\n"
+    "        for(int y = -1; y <= 1; y++) { color += TEXTURE(texture0, fragTexCoord + vec2(float(x), float(y)) * blurStep).rgb; }\n"
+    "    }\n"
+    "    color = max(color / 9.0 - THRESHOLD, 0.0) / (1.0 - THRESHOLD);\n"
+    "    FRAG_COLOR = vec4(color * mask, 1.0);\n"
+    "}\n";
+
+// Composite: applies all the layers to the world (the disabled layers have zero in the 'layerEnabled')
+internal const char* POST_COMPOSITE_FRAGMENT_SHADER = 
+    SHADER_GLSL_HEADER
+    "#define FOG_COLOR vec3(0.05, 0.16, 0.28)\n"
+    "#define CAUSTICS_COLOR vec3(0.25, 0.32, 0.32)\n"
+    "#define BLOOM_INTENSITY 0.8\n"
+    "#define BILATERAL_EPSILON 0.02\n"
+    "IN vec2 fragTexCoord;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform sampler2D fogLayer;\n"
+    "uniform sampler2D wobbleLayer;\n"
+    "uniform sampler2D causticsLayer;\n"
+    "uniform sampler2D bloomLayer;\n"
+    "uniform vec2 layerSizes[4];\n"    // fog, wobble, caustics, bloom (in texels; the same order as the 'PostPassType')
+    "uniform vec4 layerEnabled;\n"
+    "uniform vec2 wobbleScale;\n"
+    "float luma(vec3 color) { return dot(color, vec3(0.299, 0.587, 0.114)); }\n"
+    // Joint bilateral upsample: the bilinear weights of the 4 nearest low-resolution texels are reduced by how different
+    // their guide ('g') is from the full-resolution world's luma, so the layer doesn't leak across the edges.
+    "float upsample(sampler2D layer, vec2 size, vec2 uv, float guide) {\n"
+    "    vec2 position = uv * size - 0.5;\n"
+    "    vec2 f = fract(position);\n"
+    "    vec2 base = (floor(position) + 0.5) / size;\n"
+    "    vec2 texel = 1.0 / size;\n"
+    "    vec2 s00 = TEXTURE(layer, base).rg;\n"
+    "    vec2 s10 = TEXTURE(layer, base + vec2(texel.x, 0.0)).rg;\n"
+    "    vec2 s01 = TEXTURE(layer, base + vec2(0.0, texel.y)).rg;\n"
+    "    vec2 s11 = TEXTURE(layer, base + texel).rg;\n"
+    "    vec4 weights = vec4((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);\n"
+    "    weights /= BILATERAL_EPSILON + abs(vec4(s00.y, s10.y, s01.y, s11.y) - guide);\n"
+    "    return dot(weights, vec4(s00.x, s10.x, s01.x, s11.x)) / dot(weights, vec4(1.0));\n"
+    "}\n"
+    "void main() {\n"
+    "    vec2 wobble = (TEXTURE(wobbleLayer, fragTexCoord).rg * 2.0 - 1.0) * wobbleScale * layerEnabled.y;\n"
+    "    vec2 uv = fragTexCoord + wobble;\n"
+    "    vec3 color = TEXTURE(texture0, uv).rgb;\n"
+    "    float guide = luma(color);\n"
+    "    color += CAUSTICS_COLOR * upsample(causticsLayer, layerSizes[2], uv, guide) * layerEnabled.z;\n"
+    "    color = mix(color, FOG_COLOR, upsample(fogLayer, layerSizes[0], uv, guide) * layerEnabled.x);\n"
+    "    color += TEXTURE(bloomLayer, uv).rgb * BLOOM_INTENSITY * layerEnabled.w;\n"
+    "    FRAG_COLOR = vec4(color, 1.0);\n"
+    "}\n";
+
+PostProcess postProcessInit() {
+    PostProcess result = { 0 };
+
+    const char* pass_shaders[POST_PASS_COUNT] = {
+        [POST_PASS_FOG] = POST_FOG_FRAGMENT_SHADER,
+        [POST_PASS_WOBBLE] = POST_WOBBLE_FRAGMENT_SHADER,
+        [POST_PASS_CAUSTICS] = POST_CAUSTICS_FRAGMENT_SHADER,
+        [POST_PASS_BLOOM] = POST_BLOOM_FRAGMENT_SHADER
+    };
+
+    const int pass_divisors[POST_PASS_COUNT] = {
+        [POST_PASS_FOG] = POST_FOG_DIVISOR,
+        [POST_PASS_WOBBLE] = POST_WOBBLE_DIVISOR,
+        [POST_PASS_CAUSTICS] = POST_CAUSTICS_DIVISOR,
+        [POST_PASS_BLOOM] = POST_BLOOM_DIVISOR
+    };
+
+    const char* layer_names[POST_PASS_COUNT] = { "fogLayer", "wobbleLayer", "causticsLayer", "bloomLayer" };
+
+    result.ready = true;
+
+    for(int i = 0; i < POST_PASS_COUNT; i++) {
+        PostPass* pass = &result.passes[i];
+
+        pass->shader = LoadShaderFromMemory(NULL, pass_shaders[i]);
+        pass->divisor = pass_divisors[i];
+
+        result.ready &= renderShaderIsReady(pass->shader);
+
+        pass->location_world_rect = GetShaderLocation(pass->shader, "worldRect");
+        pass->location_time = GetShaderLocation(pass->shader, "time");
+    }
+
+    result.shader_composite = LoadShaderFromMemory(NULL, POST_COMPOSITE_FRAGMENT_SHADER);
+    result.ready &= renderShaderIsReady(result.shader_composite);
+
+    if(!result.ready) {
+        TraceLog(LOG_WARNING, "POST: Post-processing is not available");
+        return result;
+    }
+
+    for(int i = 0; i < POST_PASS_COUNT; i++) {
+        result.location_layers[i] = GetShaderLocation(result.shader_composite, layer_names[i]);
+    }
+
+    result.location_layer_sizes = GetShaderLocation(result.shader_composite, "layerSizes");
+    result.location_layer_enabled = GetShaderLocation(result.shader_composite, "layerEnabled");
+    result.location_wobble_scale = GetShaderLocation(result.shader_composite, "wobbleScale");
+    result.location_collectibles = GetShaderLocation(result.passes[POST_PASS_BLOOM].shader, "collectibles");
+    result.location_blur_step = GetShaderLocation(result.passes[POST_PASS_BLOOM].shader, "blurStep");
+
+    result.frame_time_average = 1.0f / RENDER_SCALE_TARGET_FPS;
+    result.cooldown = POST_BUDGET_COOLDOWN;
+    result.enabled = true;
+
+    return result;
+}
+
+RenderTexture2D* postProcessApply(PostProcess* post_process, RenderTexture2D* source) {
+    if(!post_process || !post_process->ready || !post_process->enabled) {
+        return source;
+    }
+
+    int width = source->texture.width;
+    int height = source->texture.height;
+    Rectangle bounds = GlobalState.visibility.bounds;
+
+    // Camera position modulo the pattern's period (the patterns are periodic, and the shaders are getting small numbers)
+    Vector4 world_rect = { fmodf(bounds.x, POST_PATTERN_PERIOD), bounds.y, bounds.width, bounds.height };
+    float time = fmod(GetTime(), 2.0 * PI);
+
+    Vector2 layer_sizes[POST_PASS_COUNT] = { 0 };
+    float layer_enabled[POST_PASS_COUNT] = { 0 };
+    int layer_count = 0;
+
+    for(int i = 0; i < POST_PASS_COUNT; i++) {
+        PostPass* pass = &post_process->passes[i];
+
+        if(pass->suspended) {
+            continue;
+        }
+
+        double start = GetTime();
+
+        int pass_width = Clamp(width / pass->divisor, 1, width);
+        int pass_height = Clamp(height / pass->divisor, 1, height);
+
+        renderTextureFit(&pass->target, pass_width, pass_height, TEXTURE_FILTER_BILINEAR, TEXTURE_WRAP_CLAMP);
+
+        SetShaderValue(pass->shader, pass->location_world_rect, &world_rect, SHADER_UNIFORM_VEC4);
+        SetShaderValue(pass->shader, pass->location_time, &time, SHADER_UNIFORM_FLOAT);
+
+        if(i == POST_PASS_BLOOM) {
+            postProcessSetBloomUniforms(post_process, pass, bounds, (Vector2) { width, height });
+        }
+
+        BeginTextureMode(pass->target);
+        BeginShaderMode(pass->shader);
+
+            renderTextureBlit(source->texture, (Rectangle) { 0.0f, 0.0f, pass_width, pass_height });
+
+        EndShaderMode();
+        EndTextureMode();
+
+        // (It's the CPU time of the pass - raylib has no GPU timer queries, but the 'EndTextureMode' at least flushes the draw call)
+        pass->cost = Lerp(pass->cost, (GetTime() - start) * 1000.0f, POST_COST_SMOOTHING);
+
+        layer_sizes[i] = (Vector2) { pass_width, pass_height };
+        layer_enabled[i] = 1.0f;
+        layer_count++;
+    }
+
+    // Everything is suspended, there's no need for the composite (and its extra full-resolution pass)
+    if(layer_count == 0) {
+        return source;
+    }
+
+    renderTextureFit(&post_process->output, width, height, TEXTURE_FILTER_BILINEAR, TEXTURE_WRAP_CLAMP);
+
+    Vector2 wobble_scale = { POST_WOBBLE_AMPLITUDE / bounds.width, POST_WOBBLE_AMPLITUDE / bounds.height };
+
+    SetShaderValueV(post_process->shader_composite, post_process->location_layer_sizes, layer_sizes, SHADER_UNIFORM_VEC2, POST_PASS_COUNT);
+    SetShaderValue(post_process->shader_composite, post_process->location_layer_enabled, layer_enabled, SHADER_UNIFORM_VEC4);
+    SetShaderValue(post_process->shader_composite, post_process->location_wobble_scale, &wobble_scale, SHADER_UNIFORM_VEC2);
+
+    BeginTextureMode(post_process->output);
+    BeginShaderMode(post_process->shader_composite);
+
+        // (The samplers have to be set while the shader is active; the suspended layers are bound anyway, their weight is zero)
+        for(int i = 0; i < POST_PASS_COUNT; i++) {
+            SetShaderValueTexture(post_process->shader_composite, post_process->location_layers[i], post_process->passes[i].target.texture);
+        }
+
+        renderTextureBlit(source->texture, (Rectangle) { 0.0f, 0.0f, width, height });
+
+    EndShaderMode();
+    EndTextureMode();
+
+    return &post_process->output;
+}
+
+bool postProcessUpdateBudget(PostProcess* post_process, bool resolution_full) {
+    if(!post_process || !post_process->ready || !post_process->enabled) {
+        return false;
+    }
+
+    const float FRAME_TIME_TARGET = 1.0f / RENDER_SCALE_TARGET_FPS;
+
+    // (The same averaging as the render scaler's)
+    float frame_time = Clamp(GetFrameTime(), 0.0f, FRAME_TIME_TARGET * 4.0f);
+
+    post_process->frame_time_average = Lerp(post_process->frame_time_average, frame_time, RENDER_SCALE_SMOOTHING);
+    post_process->cooldown -= frame_time;
+
+    // The last running pass and the first suspended one (the passes are suspended from the end)
+    int pass_running = -1;
+    int pass_suspended = -1;
+
+    for(int i = 0; i < POST_PASS_COUNT; i++) {
+        if(!post_process->passes[i].suspended) {
+            pass_running = i;
+        } else if(pass_suspended < 0) {
+            pass_suspended = i;
+        }
+    }
+
+    if(post_process->frame_time_average > FRAME_TIME_TARGET * POST_BUDGET_OVERLOAD) {
+        post_process->headroom_time = 0.0f;
+
+        // Nothing left to suspend, it's the render scaler's turn
+        if(pass_running < 0) {
+            return false;
+        }
+
+        if(post_process->cooldown <= 0.0f) {
+            post_process->passes[pass_running].suspended = true;
+            post_process->cooldown = POST_BUDGET_COOLDOWN;
+
+            TraceLog(LOG_INFO, "POST: Over the frame budget, pass %i suspended", pass_running);
+        }
+
+        return true;
+    }
+
+    if(post_process->frame_time_average < FRAME_TIME_TARGET * POST_BUDGET_HEADROOM) {
+        // The resolution comes back first
+        if(pass_suspended < 0 || !resolution_full) {
+            post_process->headroom_time = 0.0f;
+            return false;
+        }
+
+        post_process->headroom_time += frame_time;
+
+        if(post_process->headroom_time >= POST_BUDGET_RECOVERY_DELAY && post_process->cooldown <= 0.0f) {
+            post_process->passes[pass_suspended].suspended = false;
+            post_process->cooldown = POST_BUDGET_COOLDOWN;
+            post_process->headroom_time = 0.0f;
+
+            TraceLog(LOG_INFO, "POST: Back in the frame budget, pass %i resumed", pass_suspended);
+        }
+
+        return true;
+    }
+
+    post_process->headroom_time = 0.0f;
+
+    return false;
+}
+
+const char* postProcessGetInfo(PostProcess* post_process) {
+    if(!post_process->ready) {
+        return "unavailable";
+    }
+
+    if(!post_process->enabled) {
+        return "off";
+    }
+
+    const char* pass_names[POST_PASS_COUNT] = { "fog", "wobble", "caustics", "bloom" };
+    const char* info = "";
+
+    for(int i = 0; i < POST_PASS_COUNT; i++) {
+        PostPass* pass = &post_process->passes[i];
+
+        info = pass->suspended ?
+            frameArenaFormat(&GlobalState.frame_arena, "%s\n  - %s: suspended", info, pass_names[i]) :
+            frameArenaFormat(&GlobalState.frame_arena, "%s\n  - %s: 1/%i, %.02fms", info, pass_names[i], pass->divisor, pass->cost);
+    }
+
+    return info;
+}
+
+void postProcessUnload(PostProcess* post_process) {
+    for(int i = 0; i < POST_PASS_COUNT; i++) {
+        PostPass* pass = &post_process->passes[i];
+
+        if(pass->target.id > 0) {
+            UnloadRenderTexture(pass->target);
+        }
+
+        if(renderShaderIsReady(pass->shader)) {
+            UnloadShader(pass->shader);
+        }
+    }
+
+    if(post_process->output.id > 0) {
+        UnloadRenderTexture(post_process->output);
+    }
+
+    if(renderShaderIsReady(post_process->shader_composite)) {
+        UnloadShader(post_process->shader_composite);
+    }
+
+    *post_process = (PostProcess) { 0 };
+}
+
+internal void postProcessSetBloomUniforms(PostProcess* post_process, PostPass* pass, Rectangle bounds, Vector2 source_size) {
+    // The visible collectibles, relative to the visible world (the shader has room for 'OBSTACLE_CAPACITY' of them, the rest don't glow)
+    Vector3 collectibles[OBSTACLE_CAPACITY] = { 0 };
+    RenderVisibility* visibility = &GlobalState.visibility;
+    EntityStore* entities = &GlobalState.simulation.entities;
+
+    for(int i = 0; i < visibility->entity_count && i < OBSTACLE_CAPACITY; i++) {
+        int index = visibility->entities[i];
+
+        collectibles[i] = (Vector3) {
+            entities->position[index].x - bounds.x,
+            entities->position[index].y - bounds.y,
+            entities->radius[index]
+        };
+    }
+
+    // The blur reaches two of the pass' texels in every direction
+    Vector2 blur_step = { 2.0f * pass->divisor / source_size.x, 2.0f * pass->divisor / source_size.y };
+
+    SetShaderValueV(pass->shader, post_process->location_collectibles, collectibles, SHADER_UNIFORM_VEC3, OBSTACLE_CAPACITY);
+    SetShaderValue(pass->shader, post_process->location_blur_step, &blur_step, SHADER_UNIFORM_VEC2);
+}
+
+Vector2 worldGetSize() {
+    return (Vector2) {
+        WORLD_WIDTH,
+        WORLD_HEIGHT
+    };
+}
+
+Vector2 renderGetSize() {
+    return (Vector2) {
+        GlobalState.Game.render_texture.texture.width,
+        GlobalState.Game.render_texture.texture.height
+    };
+}
+
+Rectangle renderGetViewport() {
+    // The biggest rectangle with the world's aspect ratio that fits into the window (in screen coordinates).
+    // Everything is snapped to the whole pixels, so at the full render scale the final blit is 1:1.
+    float scale = MATH_MIN(GetScreenWidth() / worldGetSize().x, GetScreenHeight() / worldGetSize().y);
+    float width = floorf(worldGetSize().x * scale);
+    float height = floorf(worldGetSize().y * scale);
+
+    return (Rectangle) {
+        floorf((GetScreenWidth() - width) * 0.5f),
+        floorf((GetScreenHeight() - height) * 0.5f),
+        width,
+        height
+    };
+}
+
+float renderGetScale() {
+    return renderGetSize().x / worldGetSize().x;
+}
+
+void renderUpdateSize() {
+    // The render texture follows the native size of the window's viewport (in pixels, so high-DPI displays are covered as well),
+    // which is then reduced by the current level of the render scaler.
+    Rectangle viewport = renderGetViewport();
+    float dpi_scale = GetScreenWidth() > 0 ? (float) GetRenderWidth() / GetScreenWidth() : 1.0f;
+    float scale = renderScalerGetScale(&GlobalState.Game.render_scaler) * dpi_scale;
+    int width = viewport.width * scale;
+    int height = viewport.height * scale;
+
+    // Minimized window - we're keeping the last render texture, instead of creating an empty one
+    if(width <= 0 || height <= 0) {
+        return;
+    }
+
+    renderTextureFit(&GlobalState.Game.render_texture, width, height, TEXTURE_FILTER_BILINEAR, TEXTURE_WRAP_CLAMP); // (The post-processing samples around the edges)
+}
+
+Camera2D renderGetWorldCamera() {
+    Camera2D result = GlobalState.simulation.camera;
+
+    result.offset = Vector2Scale(result.offset, renderGetScale());
+    result.zoom *= renderGetScale();
+
+    return result;
+}
+
+Camera2D renderGetScreenCamera() {
+    return (Camera2D) {
+        .offset = Vector2Zero(),
+        .target = Vector2Zero(),
+        .zoom = renderGetScale()
+    };
+}
+
+Rectangle renderGetWorldBounds() {
+    // The part of the world that's visible through the 'GlobalState.simulation.camera' (in world units; the render scale doesn't change it)
+    Camera2D camera = GlobalState.simulation.camera;
+
+    return (Rectangle) {
+        camera.target.x - camera.offset.x / camera.zoom,
+        camera.target.y - camera.offset.y / camera.zoom,
+        worldGetSize().x / camera.zoom,
+        worldGetSize().y / camera.zoom
+    };
+}
+
+RenderVisibility renderVisibilityBuild(FrameArena* arena, Rectangle bounds) {
+    RenderVisibility result = { .bounds = bounds };
+
+    result.segments = frameArenaPush(arena, sizeof(int) * (OBSTACLE_CAPACITY - 1));
+    result.entities = frameArenaPush(arena, sizeof(int) * ENTITY_CAPACITY);
+    result.particles = frameArenaPush(arena, sizeof(int) * PARTICLES_CAPACITY);
+    result.strips = frameArenaPush(arena, sizeof(CorridorStrip) * RENDER_STRIP_CAPACITY);
+
+    // (Out of the arena, nothing is visible; the arena has already complained about it)
+    if(!result.segments || !result.entities || !result.particles || !result.strips) {
+        return (RenderVisibility) { .bounds = bounds };
+    }
+
+    result.segment_count = obstacleListCullSegments(bounds, result.segments);
+    result.entity_count = entityStoreCull(&GlobalState.simulation.entities, bounds, result.entities);
+    result.particle_count = particleSystemCull(&GlobalState.simulation.player.particle_system, bounds, result.particles);
+    result.strip_count = obstacleListCullStrips(bounds, result.strips, RENDER_STRIP_CAPACITY);
+
+    return result;
+}
+
+void renderWorld() {
+    // There's no world before the resources are loaded (and the 'gameInit' is called)
+    if(!resourcesIsLoaded()) {
+        return;
+    }
+
+    TRACE_BEGIN("renderWorld");
+
+    // (Every render layer below draws only its visible list; check the 'renderVisibilityBuild' in the main loop)
+    BeginMode2D(renderGetWorldCamera());
+
+        TRACE_BEGIN("backgroundRender");
+        backgroundRender(&GlobalState.background);
+        TRACE_END();
+
+        TRACE_BEGIN("playerRender");
+        playerRender();
+        TRACE_END();
+
+        TRACE_BEGIN("obstacleListRender");
+        obstacleListRender();
+        TRACE_END();
+
+        TRACE_BEGIN("debugRenderCollisions");
+        debugRenderCollisions();
+        TRACE_END();
+    
+    // (The batch is flushed here, so the draw calls' submission is a part of the 'renderWorld')
+    EndMode2D();
+
+    TRACE_END();
+}
+
+void renderUpdateFreezeFrame() {
+    RenderTexture2D* freeze_frame = &GlobalState.Game.freeze_frame;
+
+    if(renderTextureFit(freeze_frame, renderGetSize().x, renderGetSize().y, TEXTURE_FILTER_POINT, TEXTURE_WRAP_REPEAT)) {
+        GlobalState.Game.freeze_frame_valid = false;
+    }
+
+    if(GlobalState.Game.freeze_frame_valid) {
+        return;
+    }
+
+    BeginTextureMode(*freeze_frame);
+    ClearBackground(BLACK);
+
+        renderWorld();
+
+    EndTextureMode();
+
+    GlobalState.Game.freeze_frame_valid = true;
+}
+
+void renderFreezeFrame() {
+    Texture2D texture = GlobalState.Game.freeze_frame.texture;
+
+    renderTextureBlit(texture, (Rectangle) { 0.0f, 0.0f, texture.width, texture.height });
+}
+
+bool renderShaderIsReady(Shader shader) {
+    // raylib falls back to its default shader if the compilation fails
+    return shader.id > 0 && shader.id != rlGetShaderIdDefault();
+}
+
+bool renderTextureFit(RenderTexture2D* target, int width, int height, int filter, int wrap) {
+    // Every render texture follows the render size, which can change at any time (window resize, render scaler)
+    if(target->texture.width == width && target->texture.height == height) {
+        return false;
+    }
+
+    if(target->id > 0) {
+        UnloadRenderTexture(*target);
+    }
+
+    *target = LoadRenderTexture(width, height);
+    SetTextureFilter(target->texture, filter);
+    SetTextureWrap(target->texture, wrap);
+
+    return true;
+}
+
+void renderTextureBlit(Texture2D texture, Rectangle destination) {
+    // Render textures are flipped vertically, hence the negative height of the source rectangle
+    DrawTexturePro(texture, (Rectangle) { 0.0f, 0.0f, texture.width, texture.height * -1.0f }, destination, Vector2Zero(), 0.0f, WHITE);
+}
+
+void debugRender() {
+    debugRenderData();
+    debugRenderCollisions();
+}
+
+void debugRenderData() {
+    if(!GlobalState.Debug.render_data) {
+        return;
+    }
+
+    InputLatencyReport latency = inputQueueGetLatency(&GlobalState.Game.input_queue, &GlobalState.frame_arena);
+
+    SetTextLineSpacing(TEXT_FONT_SIZE);
+    DrawText(
+        frameArenaFormat(
+            &GlobalState.frame_arena,
+            "Game:\n> FPS: %i\n> State: %s\n> Time: %.02fs\n> Render: %ix%i (%i%%)\n> Corridor: %s (F4)\n> Anti-aliasing: %s (F5)\n> Post-processing: %s (F6)\n> View: %s (F3)\n> Visible: %i segments, %i entities, %i particles\n> Allocations: %llu (%llu B) / frame, %llu in this state, %lli B live\n> Frame arena: %i / %i KB (peak: %i KB)\n> Input latency: p50 %.1f, p95 %.1f, p99 %.1f ms (%i events, %s - F7)\n> Rewind: %.1fs (%i KB), snapshot: %.1f us (max: %.1f us)\n\nPlayer:\n> Position: x.%.1f, y.%.1f\n> Velocity: x.%.1f, y.%.1f\n> Alive: %s\n> Points: %i\n",
+            GetFPS(),
+            stateMachineGetName(),
+            simulationGetTime(&GlobalState.simulation),
+            (int) renderGetSize().x,
+            (int) renderGetSize().y,
+            (int) (renderGetScale() * 100.0f),
+            GlobalState.corridor_renderer.enabled ? "shader" : "CPU",
+            antiAliasingGetName(&GlobalState.Game.anti_aliasing),
+            postProcessGetInfo(&GlobalState.Game.post_process),
+            GlobalState.Debug.render_overdraw ? "overdraw (black 0, blue 1, green 2, yellow 3, orange 4, red 5, white 6+)" : "colliders",
+            GlobalState.visibility.segment_count,
+            GlobalState.visibility.entity_count,
+            GlobalState.visibility.particle_count,
+            (unsigned long long) GlobalState.Debug.memory.frame_allocations,
+            (unsigned long long) GlobalState.Debug.memory.frame_bytes,
+            (unsigned long long) GlobalState.Debug.memory.state_allocations[GlobalState.Game.gameplay_state_machine],
+            (long long) GlobalState.Debug.memory.snapshot.live_bytes,
+            (int) (GlobalState.frame_arena.used_last / 1024),
+            (int) (GlobalState.frame_arena.capacity / 1024),
+            (int) (GlobalState.frame_arena.high_water / 1024),
+            latency.p50,
+            latency.p95,
+            latency.p99,
+            latency.count,
+            GlobalState.Game.low_latency ? "low-latency" : "V-Sync",
+            GlobalState.rewind.record_count * SIMULATION_STEP,
+            (int) (GlobalState.rewind.buffer_used * sizeof(uint32_t) / 1024),
+            GlobalState.rewind.push_cost,
+            GlobalState.rewind.push_cost_max,
+
+            GlobalState.simulation.player.position.x,
+            GlobalState.simulation.player.position.y,
+
+            GlobalState.simulation.player.velocity.x,
+            GlobalState.simulation.player.velocity.y,
+
+            GlobalState.simulation.player.game_over ? "false" : "true",
+            
+            GlobalState.simulation.player.points
+        ),
+        4,
+        4,
+        TEXT_FONT_SIZE,
+        DARKGREEN
+    );
+}
+
+void debugRenderCollisions() {
+    if(!GlobalState.Debug.render_colliders) {
+        return;
+    }
+
+    for(int i = 0; i < OBSTACLE_CAPACITY - 1; i++) {
+        Obstacle* obstacle = &GlobalState.simulation.obstacle_list.list[i];
+        Obstacle* obstacle_next = &GlobalState.simulation.obstacle_list.list[i + 1];
+
+        Rectangle point0_rect = { 
+            obstacle->point0.x - OBSTACLE_WIDTH / 2.0f, 
+            obstacle->point0.y - Vector2Distance(obstacle->point0, (Vector2) { obstacle->point0.x, 0.0f } ), 
+            OBSTACLE_WIDTH, 
+            Vector2Distance(obstacle->point0, (Vector2) { obstacle->point0.x, 0.0f }) 
+        };
+
+        Rectangle point1_rect = { 
+            obstacle->point1.x - OBSTACLE_WIDTH / 2.0f, 
+            obstacle->point1.y, 
+            OBSTACLE_WIDTH, 
+            Vector2Distance(obstacle->point1, (Vector2) { obstacle->point1.x, worldGetSize().y }) 
+        };
+
+        // The heightfield is drawn as a staircase (exactly what the collisions are checked against)
+        for(int bucket = 0; bucket < OBSTACLE_HEIGHTFIELD_RESOLUTION; bucket++) {
+            float bucket_x = obstacle->position.x + bucket * OBSTACLE_HEIGHTFIELD_STEP;
+            int bucket_next = bucket < OBSTACLE_HEIGHTFIELD_RESOLUTION - 1 ? bucket + 1 : bucket;
+
+            DrawLineV((Vector2) { bucket_x, obstacle_next->height0[bucket] }, (Vector2) { bucket_x + OBSTACLE_HEIGHTFIELD_STEP, obstacle_next->height0[bucket] }, GREEN);
+            DrawLineV((Vector2) { bucket_x + OBSTACLE_HEIGHTFIELD_STEP, obstacle_next->height0[bucket] }, (Vector2) { bucket_x + OBSTACLE_HEIGHTFIELD_STEP, obstacle_next->height0[bucket_next] }, GREEN);
+
+            DrawLineV((Vector2) { bucket_x, obstacle_next->height1[bucket] }, (Vector2) { bucket_x + OBSTACLE_HEIGHTFIELD_STEP, obstacle_next->height1[bucket] }, GREEN);
+            DrawLineV((Vector2) { bucket_x + OBSTACLE_HEIGHTFIELD_STEP, obstacle_next->height1[bucket] }, (Vector2) { bucket_x + OBSTACLE_HEIGHTFIELD_STEP, obstacle_next->height1[bucket_next] }, GREEN);
+        }
+    }
+
+    EntityStore* entities = &GlobalState.simulation.entities;
+
+    for(int i = 0; i < entities->count; i++) {
+        DrawCircleLinesV(entities->position[i], entities->radius[i], GREEN);
+    }
+
+    Player* player = &GlobalState.simulation.player;
+    Rectangle player_rect = { player->position.x - (player->physical_size.x / 2.0f), player->position.y - (player->physical_size.y / 2.0f), player->physical_size.x, player->physical_size.y };
+    DrawRectangleLinesEx(player_rect, 1.0f, GREEN);
+}
+
+// Index of the calling thread's job queue ('0' - main thread)
+internal _Thread_local int job_thread_index = 0;
+
+bool traceStart(const char* path) {
+#if defined(TRACE_ENABLED)
+    // Every thread's buffer is allocated right here, so the recording never allocates on its own
+    for(int thread = 0; thread < TRACE_THREAD_CAPACITY; thread++) {
+        GlobalState.Trace.buffers[thread] = MemAlloc(sizeof(TraceBuffer));
+
+        if(!GlobalState.Trace.buffers[thread]) {
+            TraceLog(LOG_WARNING, "TRACE: Couldn't allocate the trace buffers");
+
+            for(int i = 0; i < thread; i++) {
+                MemFree(GlobalState.Trace.buffers[i]);
+                GlobalState.Trace.buffers[i] = NULL;
+            }
+
+            return false;
+        }
+    }
+
+    GlobalState.Trace.enabled = true;
+    GlobalState.Trace.path = path;
+
+    TraceLog(LOG_INFO, "TRACE: Recording into \"%s\" (written at the exit)", path);
+
+    return true;
+#else
+    (void) path;
+
+    TraceLog(LOG_WARNING, "TRACE: Tracing is compiled out (build with the 'TRACE_ENABLED' defined)");
+
+    return false;
+#endif
+}
+
+void traceBegin(const char* name) {
+    if(!GlobalState.Trace.enabled) {
+        return;
+    }
+
+    TraceBuffer* buffer = GlobalState.Trace.buffers[job_thread_index];
+
+    // Too deep - the scope is dropped, but the depth is still counted, so the 'traceEnd' stays paired
+    if(buffer->stack_depth < TRACE_STACK_CAPACITY) {
+        buffer->stack_names[buffer->stack_depth] = name;
+        buffer->stack_starts[buffer->stack_depth] = GetTime();
+    }
+
+    buffer->stack_depth++;
+}
+
+void traceEnd() {
+    if(!GlobalState.Trace.enabled) {
+        return;
+    }
+
+    TraceBuffer* buffer = GlobalState.Trace.buffers[job_thread_index];
+
+    if(!buffer || buffer->stack_depth <= 0) {
+        return;
+    }
+
+    buffer->stack_depth--;
+
+    if(buffer->stack_depth >= TRACE_STACK_CAPACITY) {
+        return;
+    }
+
+    double start = buffer->stack_starts[buffer->stack_depth];
+
+    buffer->events[buffer->event_count % TRACE_EVENT_CAPACITY] = (TraceEvent) {
+        .name = buffer->stack_names[buffer->stack_depth],
+        .start = start,
+        .duration = GetTime() - start
+    };
+
+    buffer->event_count++;
+}
+
+bool traceWrite() {
+    if(!GlobalState.Trace.enabled) {
+        return false;
+    }
+
+    GlobalState.Trace.enabled = false;
+
+    FILE* file = fopen(GlobalState.Trace.path, "w");
+
+    if(!file) {
+        TraceLog(LOG_WARNING, "TRACE: Couldn't open \"%s\"", GlobalState.Trace.path);
+    }
+
+    // Chrome's trace event format (the complete 'X' events, in microseconds); opens in the 'chrome://tracing' and in the Perfetto UI
+    if(file) {
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    }
 
-        Vector2 points1[4] = {
-            obstacle->point1,
-            obstacle_next->point1,
-            (Vector2) { obstacle->point1.x + OBSTACLE_WIDTH / 2.0f, obstacle->point1.y },
-            (Vector2) { obstacle_next->point1.x - OBSTACLE_WIDTH / 2.0f, obstacle_next->point1.y }
-        };
+    bool first = true;
+    uint64_t event_total = 0;
 
-        Vector2 points0_midpoints[3] = {
-            GetSplinePointBezierCubic(points0[0], points0[2], points0[3], points0[1], 0.25f),
-            GetSplinePointBezierCubic(points0[0], points0[2], points0[3], points0[1], 0.5f),
-            GetSplinePointBezierCubic(points0[0], points0[2], points0[3], points0[1], 0.75f),
-        };
-        Vector2 points1_midpoints[3] = {
-            GetSplinePointBezierCubic(points1[0], points1[2], points1[3], points1[1], 0.25f),
-            GetSplinePointBezierCubic(points1[0], points1[2], points1[3], points1[1], 0.5f),
-            GetSplinePointBezierCubic(points1[0], points1[2], points1[3], points1[1], 0.75f),
-        }; 
-
-        if(collisionCheckRectLine(player_rect, obstacle->point0, points0_midpoints[0]) || 
-        collisionCheckRectLine(player_rect, points0_midpoints[0], points0_midpoints[1]) ||
-        collisionCheckRectLine(player_rect, points0_midpoints[1], points0_midpoints[2]) ||
-        collisionCheckRectLine(player_rect, points0_midpoints[2], obstacle_next->point0)){
-            player->game_over = true;
+    for(int thread = 0; thread < TRACE_THREAD_CAPACITY; thread++) {
+        TraceBuffer* buffer = GlobalState.Trace.buffers[thread];
+
+        if(!buffer) {
+            continue;
         }
 
-        if(collisionCheckRectLine(player_rect, obstacle->point1, points1_midpoints[0]) || 
-        collisionCheckRectLine(player_rect, points1_midpoints[0], points1_midpoints[1]) ||
-        collisionCheckRectLine(player_rect, points1_midpoints[1], points1_midpoints[2]) ||
-        collisionCheckRectLine(player_rect, points1_midpoints[2], obstacle_next->point1)){
-            player->game_over = true;
+        // (The threads that never recorded anything aren't listed)
+        if(buffer->event_count == 0) {
+            MemFree(buffer);
+            GlobalState.Trace.buffers[thread] = NULL;
+            continue;
         }
 
-        if(obstacle->has_collectible) {
-            if(CheckCollisionCircleRec(obstacle->collectible.position, COLLECTLIBLE_RADIUS, player_rect)) {
-                switch (obstacle->collectible.collectible_rarity) {
-                    case COLLECTIBLE_COMMON:            player->points++;       player->collected_common++;     break;
-                    case COLLECTLIBLE_RARE:             player->points += 2;    player->collected_rare++;       break;
-                    case COLLECTLIBLE_LEGENDARY:        player->points += 4;    player->collected_legendary++;  break;
-                    case COLLECTIBLE_RARITY_COUNT:      player->points += 0;                                    break;
-                    default:                            player->points += 0;                                    break;
-                }
+        uint64_t event_first = buffer->event_count > TRACE_EVENT_CAPACITY ? buffer->event_count - TRACE_EVENT_CAPACITY : 0;
+
+        if(file) {
+            fprintf(
+                file, 
+                "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%i,\"args\":{\"name\":\"%s %i\"}}", 
+                first ? "" : ",\n", 
+                thread, 
+                thread == 0 ? "main" : "worker", 
+                thread
+            );
 
-                PlaySound(GlobalState.Resources.sound_collectible_pickup);
+            first = false;
 
-                obstacle->has_collectible = false;
+            for(uint64_t i = event_first; i < buffer->event_count; i++) {
+                TraceEvent* event = &buffer->events[i % TRACE_EVENT_CAPACITY];
+
+                fprintf(
+                    file, 
+                    ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f}", 
+                    event->name, 
+                    thread, 
+                    event->start * 1000000.0, 
+                    event->duration * 1000000.0
+                );
             }
         }
-    }
-}
 
-Obstacle obstacleInit(Vector2 position, float distance, bool spawn_collectible){
-    Obstacle result = {
-        .position = position,
-        .distance = distance,
+        event_total += buffer->event_count - event_first;
 
-        .point0.x = position.x,
-        .point1.x = position.x,
-    };
+        MemFree(buffer);
+        GlobalState.Trace.buffers[thread] = NULL;
+    }
 
-    result.point0.y = position.y - (distance / 2.0f);
-    result.point1.y = position.y + (distance / 2.0f);
-    
-    // Simple check if there is a space for collectible to be spawned
-    if(distance > COLLECTLIBLE_RADIUS * 2.0f && spawn_collectible) {
-        // RNG that picks if the collectible will be spawned
-        if(GetRandomValue(0, COLLECTIBLE_SPAWN_CHANCE) == COLLECTIBLE_SPAWN_CHANCE_VALUE) {
-            result.has_collectible = true;
-            result.collectible = collectibleInit(&result);
-        } 
+    if(!file) {
+        return false;
     }
 
-    return result;
-}
+    fprintf(file, "\n]}\n");
+    fclose(file);
 
-Collectible collectibleInit(Obstacle* obstacle) {
-    Collectible result = (Collectible) { 
-        .position = (Vector2) { 
-            obstacle->position.x - GetRandomValue(
-                (OBSTACLE_WIDTH / -2.0f) + (COLLECTLIBLE_RADIUS * 2.0f), 
-                (OBSTACLE_WIDTH / 2.0f) - (COLLECTLIBLE_RADIUS * 2.0f)
-            ),
-            // This formula either substracts or add a value, which is in between the point0 and point1 from the position.y value. It accounts the radius of the collectible
-            obstacle->position.y - GetRandomValue(
-                (obstacle->distance / -2.0f) + (COLLECTLIBLE_RADIUS * 2.0f), 
-                (obstacle->distance / 2.0f) - (COLLECTLIBLE_RADIUS * 2.0f)
-            )
-        },
-        .sprite_rotation = GetRandomValue(-30, 30)
-    };
+    TraceLog(LOG_INFO, "TRACE: %llu events written into \"%s\"", (unsigned long long) event_total, GlobalState.Trace.path);
 
-    // 'collectible_rarity_random_index' picks the random value...
-    int collectible_rarity_random_index = GetRandomValue(0, 30);
-    // .. which then helps us assign the proper rarity to our collectible.
+    return true;
+}
 
-    if(collectible_rarity_random_index >= 0 && collectible_rarity_random_index < 16) { // If 'collectible_rarity_random_index' is in range 0 - 15, then the rarity is COLLECTIBLE_COMMON (50%)
-        result.collectible_rarity = COLLECTIBLE_COMMON;
-    } else if(collectible_rarity_random_index >= 16 && collectible_rarity_random_index < 26) { // Otherwise, if 'collectible_rarity_random_index' is in range 16 - 25, then the rarity is COLLECTLIBLE_RARE (33%)
-        result.collectible_rarity = COLLECTLIBLE_RARE;
-    } else if(collectible_rarity_random_index >= 26 && collectible_rarity_random_index < 31) { // lastly, if 'collectible_rarity_random_index' is in range 26 - 30, then the rarity is COLLECTLIBLE_LEGENDARY (17%)
-        result.collectible_rarity = COLLECTLIBLE_LEGENDARY;
+#if defined(JOB_SYSTEM_THREADED)
+    #define JOB_QUEUE_LOCK(queue) pthread_mutex_lock(&(queue)->mutex)
+    #define JOB_QUEUE_UNLOCK(queue) pthread_mutex_unlock(&(queue)->mutex)
+#else
+    #define JOB_QUEUE_LOCK(queue)
+    #define JOB_QUEUE_UNLOCK(queue)
+#endif
+
+internal void jobCounterLock(JobCounter* counter) {
+    while(atomic_flag_test_and_set_explicit(&counter->continuation_lock, memory_order_acquire)) {
+#if defined(JOB_SYSTEM_THREADED)
+        sched_yield();
+#endif
     }
+}
 
-    return result;
+internal void jobCounterUnlock(JobCounter* counter) {
+    atomic_flag_clear_explicit(&counter->continuation_lock, memory_order_release);
 }
 
-void collectibleUpdate(Obstacle* obstacle) {
-    if(!obstacle || !obstacle->has_collectible) {
+internal void jobRun(JobSystem* job_system, Job job) {
+    TRACE_BEGIN("job");
+    job.function(job.data);
+    TRACE_END();
+
+    if(!job.counter) {
         return;
     }
-    
-    obstacle->collectible.position = Vector2Lerp(
-        obstacle->collectible.position, 
-        (Vector2) {
-            obstacle->point1.x,
-            obstacle->point1.y - RESOURCES_SPRITE_COLLECTIBLES->height / 2.0f
-        }, 
-        GetFrameTime() * 0.1f
-    );
-}
 
-void collectibleRender(Obstacle* obstacle) {
-    if(!obstacle || !obstacle->has_collectible) {
-        return;
+    // The last job of the counter releases everything that was waiting for it
+    Job continuations[JOB_CONTINUATION_CAPACITY];
+    int continuation_count = 0;
+
+    jobCounterLock(job.counter);
+
+    if(atomic_fetch_sub_explicit(&job.counter->value, 1, memory_order_acq_rel) == 1) {
+        continuation_count = job.counter->continuation_count;
+
+        for(int i = 0; i < continuation_count; i++) {
+            continuations[i] = job.counter->continuations[i];
+        }
+
+        job.counter->continuation_count = 0;
     }
 
-    DrawTexturePro(
-        GlobalState.Resources.texture_collectibles[obstacle->collectible.collectible_rarity],
-        (Rectangle) {
-            0,
-            0,
-            GlobalState.Resources.texture_collectibles[obstacle->collectible.collectible_rarity].width,
-            GlobalState.Resources.texture_collectibles[obstacle->collectible.collectible_rarity].height
-        },
-        (Rectangle) {
-            obstacle->collectible.position.x,
-            obstacle->collectible.position.y,
-            COLLECTLIBLE_RADIUS * 2,
-            COLLECTLIBLE_RADIUS * 2
-        },
-        (Vector2) { COLLECTLIBLE_RADIUS, COLLECTLIBLE_RADIUS },
-        obstacle->collectible.sprite_rotation,
-        WHITE
-    );
+    jobCounterUnlock(job.counter);
 
+    for(int i = 0; i < continuation_count; i++) {
+        jobSystemPush(job_system, continuations[i]);
+    }
 }
 
-ObstacleList obstacleListInit() {
-    ObstacleList result = { 0 };
+internal void jobSystemPush(JobSystem* job_system, Job job) {
+    JobQueue* queue = &job_system->queues[job_thread_index];
 
-    Vector2 obstacle_position = { 0.0f, renderGetSize().y / 2.0f };
-    float obstacle_distance = OBSTACLE_DIST_INITIAL;
+    JOB_QUEUE_LOCK(queue);
 
-    result.list[0] = obstacleInit(obstacle_position, obstacle_distance, false);
+    bool queue_full = queue->count >= JOB_QUEUE_CAPACITY || !atomic_load(&job_system->running);
 
-    for(int obstacle_index = 1; obstacle_index < OBSTACLE_CAPACITY; obstacle_index++) {
-        int obstacle_move_direction = 0;
+    if(!queue_full) {
+        queue->jobs[(queue->top + queue->count) % JOB_QUEUE_CAPACITY] = job;
+        queue->count++;
+    }
+
+    JOB_QUEUE_UNLOCK(queue);
+
+    // No space in the queue - the job is never dropped, it just runs right away on the calling thread
+    if(queue_full) {
+        jobRun(job_system, job);
+        return;
+    }
 
-        // RNG that picks the horizontal direction that the next obstacle will be placed (1 - 5 -> up; (-1) - (-5) -> down)
-        do {
-            obstacle_move_direction = GetRandomValue(-5, 5);
-        } while(obstacle_move_direction == 0);
+    atomic_fetch_add_explicit(&job_system->pending_count, 1, memory_order_release);
 
-        obstacle_position.x += OBSTACLE_WIDTH;
-        obstacle_position.y = result.list[obstacle_index - 1].position.y + obstacle_move_direction * (OBSTACLE_DIST_REDUCTION * 2);
-        obstacle_position.y = Clamp(obstacle_position.y, obstacle_distance / 2.0f + 32.0f, renderGetSize().y - obstacle_distance / 2.0f - 32.0f);
+#if defined(JOB_SYSTEM_THREADED)
+    pthread_mutex_lock(&job_system->sleep_mutex);
+    pthread_cond_signal(&job_system->sleep_condition);
+    pthread_mutex_unlock(&job_system->sleep_mutex);
+#endif
+}
+
+internal bool jobSystemPop(JobSystem* job_system, Job* job) {
+    JobQueue* queue = &job_system->queues[job_thread_index];
+    bool has_job = false;
 
-        obstacle_distance = obstacle_distance >= OBSTACLE_DIST_MIN ?
-            obstacle_distance - OBSTACLE_DIST_REDUCTION * GetRandomValue(1, 2) :
-            obstacle_distance;
+    JOB_QUEUE_LOCK(queue);
 
-        result.list[obstacle_index] = obstacleInit(obstacle_position, obstacle_distance, obstacle_index >= OBSTACLE_CAPACITY / 2);
+    if(queue->count > 0) {
+        queue->count--;
+        *job = queue->jobs[(queue->top + queue->count) % JOB_QUEUE_CAPACITY];
+        has_job = true;
     }
 
-    return result;
+    JOB_QUEUE_UNLOCK(queue);
+
+    if(has_job) {
+        atomic_fetch_sub_explicit(&job_system->pending_count, 1, memory_order_relaxed);
+    }
+
+    return has_job;
 }
 
-void obstacleInitData(Obstacle* obstacle, Vector2* position, float* distance) {
-    int obstacle_move_direction = 0;
+internal bool jobSystemSteal(JobSystem* job_system, Job* job) {
+    int queue_count = atomic_load_explicit(&job_system->worker_count, memory_order_relaxed) + 1;
 
-    // RNG that picks the horizontal direction that the next obstacle will be placed (1 - 5 -> up; (-1) - (-5) -> down)
-    do {
-        obstacle_move_direction = GetRandomValue(-5, 5);
-    } while(obstacle_move_direction == 0);
+    // Every thread starts looking at its neighbour, so the thieves don't pile up on the same queue
+    for(int i = 1; i < queue_count; i++) {
+        JobQueue* queue = &job_system->queues[(job_thread_index + i) % queue_count];
+        bool has_job = false;
 
-    *position = (Vector2) {
-        obstacle->position.x + OBSTACLE_WIDTH,
-        obstacle->position.y + obstacle_move_direction * (OBSTACLE_DIST_REDUCTION * 2)
-    };
+        JOB_QUEUE_LOCK(queue);
 
-    *distance = obstacle->distance >= OBSTACLE_DIST_MIN ?
-        obstacle->distance - OBSTACLE_DIST_REDUCTION * GetRandomValue(1, 2) :
-        obstacle->distance;
+        if(queue->count > 0) {
+            *job = queue->jobs[queue->top];
+            queue->top = (queue->top + 1) % JOB_QUEUE_CAPACITY;
+            queue->count--;
+            has_job = true;
+        }
 
-    position->y = Clamp(position->y, *distance / 2.0f + 32.0f, renderGetSize().y - *distance / 2.0f - 32.0f);
-}
+        JOB_QUEUE_UNLOCK(queue);
 
-void obstacleListUpdate() {
-    obstacleListLoopObstacles();
-    
-    for(int i = 0; i < OBSTACLE_CAPACITY; i++) {
-        collectibleUpdate(&GlobalState.obstacle_list.list[i]);
+        if(has_job) {
+            atomic_fetch_sub_explicit(&job_system->pending_count, 1, memory_order_relaxed);
+            return true;
+        }
     }
+
+    return false;
 }
 
-void obstacleListRender() {
-    const int LINE_THICKNESS = 4;
+#if defined(JOB_SYSTEM_THREADED)
+
+internal int jobSystemGetCoreCount() {
+#if defined(_WIN32)
+    // (windows.h collides with raylib, so we're asking the environment instead)
+    const char* core_count = getenv("NUMBER_OF_PROCESSORS");
+    return core_count ? atoi(core_count) : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    return (int) sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    return 1;
+#endif
+}
 
-    for(int obstacle_index = 0; obstacle_index < OBSTACLE_CAPACITY - 1; obstacle_index++) {
-        Obstacle* obstacle_current = &GlobalState.obstacle_list.list[obstacle_index];
-        Obstacle* obstacle_next = &GlobalState.obstacle_list.list[obstacle_index + 1];
-        
+typedef struct {
+    JobSystem* job_system;
+    int thread_index;
+} JobWorkerArguments;
 
-        Vector2 points0[4] = {
-            obstacle_current->point0,
-            obstacle_next->point0,
-            (Vector2) { obstacle_current->point0.x + OBSTACLE_WIDTH / 2.0f, obstacle_current->point0.y },
-            (Vector2) { obstacle_next->point0.x - OBSTACLE_WIDTH / 2.0f, obstacle_next->point0.y }
-        };
+internal void* jobSystemWorker(void* argument) {
+    JobWorkerArguments* arguments = (JobWorkerArguments*) argument;
+    JobSystem* job_system = arguments->job_system;
 
-        Vector2 points1[4] = {
-            obstacle_current->point1,
-            obstacle_next->point1,
-            (Vector2) { obstacle_current->point1.x + OBSTACLE_WIDTH / 2.0f, obstacle_current->point1.y },
-            (Vector2) { obstacle_next->point1.x - OBSTACLE_WIDTH / 2.0f, obstacle_next->point1.y }
-        };
+    job_thread_index = arguments->thread_index;
 
-        for(int points0_index = 0; points0_index < OBSTACLE_WIDTH / 2.0f; points0_index++) {
-            Vector2 spline_point = GetSplinePointBezierCubic(
-                points0[0], 
-                points0[2], 
-                points0[3], 
-                points0[1], 
-                points0_index / (OBSTACLE_WIDTH / 2.0f)
-            );
+    while(true) {
+        Job job = { 0 };
 
-            DrawRectangleGradientV(
-                spline_point.x, 
-                0.0f, 
-                LINE_THICKNESS, 
-                Vector2Distance(
-                    spline_point, 
-                    (Vector2) { 
-                        spline_point.x, 
-                        0.0f
-                    }
-                ), 
-                GetColor(0x3e3546ff), 
-                GetColor(OBSTACLE_UPPER_COLOR)
-            );
+        if(jobSystemPop(job_system, &job) || jobSystemSteal(job_system, &job)) {
+            jobRun(job_system, job);
+            continue;
         }
 
-        for(int points1_index = 0; points1_index < OBSTACLE_WIDTH / 2.0f; points1_index++) {
-            Vector2 spline_point = GetSplinePointBezierCubic(
-                points1[0], 
-                points1[2], 
-                points1[3], 
-                points1[1], 
-                points1_index / (OBSTACLE_WIDTH / 2.0f)
-            );
+        // Nothing to do anywhere - sleeping until the next submission.
+        // Shutting down: the queues are drained first, so nobody waits for the job that'll never run
+        pthread_mutex_lock(&job_system->sleep_mutex);
 
-            DrawRectangleGradientV(
-                spline_point.x, 
-                spline_point.y, 
-                LINE_THICKNESS, 
-                Vector2Distance(
-                    spline_point, 
-                    (Vector2) { 
-                        spline_point.x, 
-                        renderGetSize().y + 1
-                    }
-                ), 
-                GetColor(OBSTACLE_LOWER_COLOR),
-                GetColor(0xf79617ff) 
-            );
+        while(atomic_load(&job_system->running) && atomic_load_explicit(&job_system->pending_count, memory_order_acquire) <= 0) {
+            pthread_cond_wait(&job_system->sleep_condition, &job_system->sleep_mutex);
         }
 
-        DrawSplineSegmentBezierCubic(
-            points0[0], 
-            points0[2], 
-            points0[3], 
-            points0[1], 
-            LINE_THICKNESS,
-            GetColor(GAME_LINES_COLOR)    
-        );
+        bool quit = !atomic_load(&job_system->running) && atomic_load_explicit(&job_system->pending_count, memory_order_acquire) <= 0;
 
-        DrawSplineSegmentBezierCubic(
-            points1[0], 
-            points1[2], 
-            points1[3], 
-            points1[1], 
-            LINE_THICKNESS,
-            GetColor(GAME_LINES_COLOR)
-        );
+        pthread_mutex_unlock(&job_system->sleep_mutex);
 
-        collectibleRender(obstacle_current);
+        if(quit) {
+            break;
+        }
     }
+
+    return NULL;
 }
 
-void obstacleListLoopObstacles() {
-    ObstacleList* obstacle_list = &GlobalState.obstacle_list;
-    Obstacle* obstacle_current = &obstacle_list->list[0];
-        
-    if(GetWorldToScreen2D(obstacle_current->position, GlobalState.camera).x < -OBSTACLE_WIDTH) {
-        for(int i = 0; i < OBSTACLE_CAPACITY - 1; i++) {
-            obstacle_list->list[i] = obstacle_list->list[i + 1];
-        }
+#endif
 
-        obstacle_current = &obstacle_list->list[OBSTACLE_CAPACITY - 1];
+void jobSystemInit(JobSystem* job_system) {
+    *job_system = (JobSystem) { 0 };
+    atomic_store(&job_system->running, true);
 
-        Vector2 obstacle_position = { 0 };
-        float obstacle_distance = 0.0f;
+#if defined(JOB_SYSTEM_THREADED)
+    static JobWorkerArguments worker_arguments[JOB_WORKER_CAPACITY];
 
-        obstacleInitData(&obstacle_list->list[OBSTACLE_CAPACITY - 2], &obstacle_position, &obstacle_distance);
+    pthread_mutex_init(&job_system->sleep_mutex, NULL);
+    pthread_cond_init(&job_system->sleep_condition, NULL);
 
-        *obstacle_current = obstacleInit(
-            obstacle_position, 
-            obstacle_distance, 
-            true
-        );
+    for(int i = 0; i < JOB_WORKER_CAPACITY + 1; i++) {
+        pthread_mutex_init(&job_system->queues[i].mutex, NULL);
     }
-}
 
-Background backgroundInit() {
-    return (Background) {
-        .bg_pos0 = Vector2Zero(),
-        .bg_pos1 = (Vector2) {
-            renderGetSize().x,
-            0.0f
+    // One core is left for the main thread
+    int worker_count = Clamp(jobSystemGetCoreCount() - 1, 1, JOB_WORKER_CAPACITY);
+
+    // 'worker_count' has to be known before any worker starts stealing
+    atomic_store(&job_system->worker_count, worker_count);
+
+    for(int i = 0; i < worker_count; i++) {
+        worker_arguments[i] = (JobWorkerArguments) { job_system, i + 1 };
+
+        if(pthread_create(&job_system->workers[i], NULL, jobSystemWorker, &worker_arguments[i]) != 0) {
+            TraceLog(LOG_WARNING, "JOBS: Failed to create the worker thread %i", i);
+            worker_count = i;
+            break;
         }
-    };
+    }
+
+    // (Failed thread creation leaves the empty queues at the end, which are harmless for the thieves)
+    atomic_store(&job_system->worker_count, worker_count);
+
+    TraceLog(LOG_INFO, "JOBS: Job system initialized with %i worker thread(s)", worker_count);
+#endif
 }
 
-void backgroundUpdate(Background* background) {
-    if(!background) {
-        return;
-    }
+void jobSystemShutdown(JobSystem* job_system) {
+#if defined(JOB_SYSTEM_THREADED)
+    pthread_mutex_lock(&job_system->sleep_mutex);
+    atomic_store(&job_system->running, false);
+    pthread_cond_broadcast(&job_system->sleep_condition);
+    pthread_mutex_unlock(&job_system->sleep_mutex);
 
-    if(background->bg_pos0.x <= (GlobalState.camera.target.x - GlobalState.camera.offset.x) - renderGetSize().x) {
-        background->bg_pos0.x += (renderGetSize().x * 2.0f) + ((int) background->bg_pos0.x % (int) renderGetSize().x);
+    for(int i = 0; i < atomic_load(&job_system->worker_count); i++) {
+        pthread_join(job_system->workers[i], NULL);
     }
-    
-    if(background->bg_pos1.x <= (GlobalState.camera.target.x - GlobalState.camera.offset.x) - renderGetSize().x) {
-        background->bg_pos1.x += (renderGetSize().x * 2.0f) + ((int) background->bg_pos1.x % (int) renderGetSize().x);
+
+    // The main thread's queue isn't drained by the workers that are already gone
+    while(jobSystemHelp(job_system));
+
+    for(int i = 0; i < JOB_WORKER_CAPACITY + 1; i++) {
+        pthread_mutex_destroy(&job_system->queues[i].mutex);
     }
-}
 
-void backgroundRender(Background* background) {
-    DrawTexturePro(
-        GlobalState.Resources.texture_background, 
-        (Rectangle) {
-            0.0f,
-            0.0f,
-            GlobalState.Resources.texture_background.width,
-            GlobalState.Resources.texture_background.height
-        }, 
-        (Rectangle) {
-            background->bg_pos0.x,
-            background->bg_pos0.y,
-            renderGetSize().x,
-            renderGetSize().y
-        }, 
-        Vector2Zero(), 
-        0.0f, 
-        WHITE
-    );
+    pthread_cond_destroy(&job_system->sleep_condition);
+    pthread_mutex_destroy(&job_system->sleep_mutex);
+#else
+    while(jobSystemHelp(job_system));
+    atomic_store(&job_system->running, false);
+#endif
 
-    DrawTexturePro(
-        GlobalState.Resources.texture_background, 
-        (Rectangle) {
-            0.0f,
-            0.0f,
-            GlobalState.Resources.texture_background.width,
-            GlobalState.Resources.texture_background.height
-        }, 
-        (Rectangle) {
-            background->bg_pos1.x,
-            background->bg_pos1.y,
-            renderGetSize().x,
-            renderGetSize().y
-        }, 
-        Vector2Zero(), 
-        0.0f, 
-        WHITE
-    );
+    atomic_store(&job_system->worker_count, 0);
 }
 
-Vector2 renderGetSize() {
-    return (Vector2) {
-        GlobalState.Game.render_texture.texture.width,
-        GlobalState.Game.render_texture.texture.height
-    };
-}
+void jobSystemSubmit(JobSystem* job_system, JobFunction function, void* data, JobCounter* counter) {
+    if(counter) {
+        atomic_fetch_add_explicit(&counter->value, 1, memory_order_relaxed);
+    }
 
-void debugRender() {
-    debugRenderData();
-    debugRenderCollisions();
+    jobSystemPush(job_system, (Job) {
+        .function = function,
+        .data = data,
+        .counter = counter
+    });
 }
 
-void debugRenderData() {
-    if(!GlobalState.Debug.render_data) {
-        return;
+void jobSystemSubmitAfter(JobSystem* job_system, JobFunction function, void* data, JobCounter* counter, JobCounter* dependency) {
+    // NOTE: All the jobs of the 'dependency' have to be submitted before this call,
+    // otherwise the counter could reach zero in between and release this job too early.
+    Job job = {
+        .function = function,
+        .data = data,
+        .counter = counter
+    };
+
+    if(counter) {
+        atomic_fetch_add_explicit(&counter->value, 1, memory_order_relaxed);
     }
 
-    SetTextLineSpacing(TEXT_FONT_SIZE);
-    DrawText(
-        TextFormat(
-            "Game:\n> FPS: %i\n> State: %s\n> Time: %.02fs\n\nPlayer:\n> Position: x.%.1f, y.%.1f\n> Velocity: x.%.1f, y.%.1f\n> Alive: %s\n> Points: %i\n",
-            GetFPS(),
-            stateMachineGetName(),
-            GlobalState.Game.gameplay_time,
+    bool deferred = false;
 
-            GlobalState.player.position.x,
-            GlobalState.player.position.y,
+    if(dependency) {
+        jobCounterLock(dependency);
 
-            GlobalState.player.velocity.x,
-            GlobalState.player.velocity.y,
+        if(!jobCounterIsDone(dependency) && dependency->continuation_count < JOB_CONTINUATION_CAPACITY) {
+            dependency->continuations[dependency->continuation_count++] = job;
+            deferred = true;
+        }
 
-            GlobalState.player.game_over ? "false" : "true",
-            
-            GlobalState.player.points
-        ),
-        4,
-        4,
-        TEXT_FONT_SIZE,
-        DARKGREEN
-    );
-}
+        jobCounterUnlock(dependency);
 
-void debugRenderCollisions() {
-    if(!GlobalState.Debug.render_colliders) {
-        return;
+        // No space for another continuation - waiting for the dependency right here is slower, but still correct
+        if(!deferred && !jobCounterIsDone(dependency)) {
+            jobSystemWait(job_system, dependency);
+        }
     }
 
-    for(int i = 0; i < OBSTACLE_CAPACITY - 1; i++) {
-        Obstacle* obstacle = &GlobalState.obstacle_list.list[i];
-        Obstacle* obstacle_next = &GlobalState.obstacle_list.list[i + 1];
-
-        Rectangle point0_rect = { 
-            obstacle->point0.x - OBSTACLE_WIDTH / 2.0f, 
-            obstacle->point0.y - Vector2Distance(obstacle->point0, (Vector2) { obstacle->point0.x, 0.0f } ), 
-            OBSTACLE_WIDTH, 
-            Vector2Distance(obstacle->point0, (Vector2) { obstacle->point0.x, 0.0f }) 
-        };
+    if(!deferred) {
+        jobSystemPush(job_system, job);
+    }
+}
 
-        Rectangle point1_rect = { 
-            obstacle->point1.x - OBSTACLE_WIDTH / 2.0f, 
-            obstacle->point1.y, 
-            OBSTACLE_WIDTH, 
-            Vector2Distance(obstacle->point1, (Vector2) { obstacle->point1.x, renderGetSize().y }) 
-        };
+bool jobSystemHelp(JobSystem* job_system) {
+    Job job = { 0 };
 
-        Vector2 points0[4] = {
-            obstacle->point0,
-            obstacle_next->point0,
-            (Vector2) { obstacle->point0.x + OBSTACLE_WIDTH / 2.0f, obstacle->point0.y },
-            (Vector2) { obstacle_next->point0.x - OBSTACLE_WIDTH / 2.0f, obstacle_next->point0.y }
-        };
+    if(jobSystemPop(job_system, &job) || jobSystemSteal(job_system, &job)) {
+        jobRun(job_system, job);
+        return true;
+    }
 
-        Vector2 points1[4] = {
-            obstacle->point1,
-            obstacle_next->point1,
-            (Vector2) { obstacle->point1.x + OBSTACLE_WIDTH / 2.0f, obstacle->point1.y },
-            (Vector2) { obstacle_next->point1.x - OBSTACLE_WIDTH / 2.0f, obstacle_next->point1.y }
-        };
+    return false;
+}
 
-        Vector2 points0_midpoints[3] = {
-            GetSplinePointBezierCubic(points0[0], points0[2], points0[3], points0[1], 0.25f),
-            GetSplinePointBezierCubic(points0[0], points0[2], points0[3], points0[1], 0.5f),
-            GetSplinePointBezierCubic(points0[0], points0[2], points0[3], points0[1], 0.75f),
-        };
-        Vector2 points1_midpoints[3] = {
-            GetSplinePointBezierCubic(points1[0], points1[2], points1[3], points1[1], 0.25f),
-            GetSplinePointBezierCubic(points1[0], points1[2], points1[3], points1[1], 0.5f),
-            GetSplinePointBezierCubic(points1[0], points1[2], points1[3], points1[1], 0.75f),
-        }; 
-
-        DrawLineEx(obstacle->point0, points0_midpoints[0], 1.0f, GREEN);
-        DrawLineEx(points0_midpoints[0], points0_midpoints[1], 1.0f, GREEN);
-        DrawLineEx(points0_midpoints[1], points0_midpoints[2], 1.0f, GREEN);
-        DrawLineEx(points0_midpoints[2], obstacle_next->point0, 1.0f, GREEN);
-
-        DrawLineEx(obstacle->point1, points1_midpoints[0], 1.0f, GREEN);
-        DrawLineEx(points1_midpoints[0], points1_midpoints[1], 1.0f, GREEN);
-        DrawLineEx(points1_midpoints[1], points1_midpoints[2], 1.0f, GREEN);
-        DrawLineEx(points1_midpoints[2], obstacle_next->point1, 1.0f, GREEN);
-
-        if(obstacle->has_collectible) {
-            DrawCircleLinesV(
-                obstacle->collectible.position, 
-                COLLECTLIBLE_RADIUS, 
-                GREEN
-            );
+void jobSystemWait(JobSystem* job_system, JobCounter* counter) {
+    // The waiting thread isn't idle - it executes (or steals) the pending jobs until the counter reaches zero.
+    // That's the barrier in between the simulation and the rendering.
+    while(!jobCounterIsDone(counter)) {
+        if(!jobSystemHelp(job_system)) {
+#if defined(JOB_SYSTEM_THREADED)
+            sched_yield();
+#endif
         }
     }
 
-    Player* player = &GlobalState.player;
-    Rectangle player_rect = { player->position.x - (player->physical_size.x / 2.0f), player->position.y - (player->physical_size.y / 2.0f), player->physical_size.x, player->physical_size.y };
-    DrawRectangleLinesEx(player_rect, 1.0f, GREEN);
+    // The thread that finished the last job might still hold the counter's lock,
+    // so the (often stack-allocated) counter can't go out of scope before it's released.
+    if(counter) {
+        jobCounterLock(counter);
+        jobCounterUnlock(counter);
+    }
+}
+
+bool jobCounterIsDone(JobCounter* counter) {
+    return !counter || atomic_load_explicit(&counter->value, memory_order_acquire) <= 0;
 }
 
 internal bool collisionCheckRectLine(Rectangle rect, Vector2 line_start, Vector2 line_end) {
@@ -1681,6 +5644,27 @@ internal bool collisionCheckRectLine(Rectangle rect, Vector2 line_start, Vector2
     return collision_rect_up || collision_rect_down || collision_rect_left || collision_rect_right;
 }
 
+internal bool collisionCheckCircleRec(Vector2 center, float radius, Rectangle rect) {
+    // The same test as the raylib's 'CheckCollisionCircleRec', but without the early-outs (the closest point of the rectangle is just clamped),
+    // so it compiles to the min / max instructions and the entity loops don't branch on it.
+    // (The ternaries, not the 'fminf' / 'fmaxf': because of their NaN rules, those are library calls unless the math is relaxed)
+    float closest_x = center.x < rect.x ? rect.x : center.x;
+    float closest_y = center.y < rect.y ? rect.y : center.y;
+
+    closest_x = closest_x > rect.x + rect.width ? rect.x + rect.width : closest_x;
+    closest_y = closest_y > rect.y + rect.height ? rect.y + rect.height : closest_y;
+
+    float distance_x = center.x - closest_x;
+    float distance_y = center.y - closest_y;
+
+    return distance_x * distance_x + distance_y * distance_y <= radius * radius;
+}
+
+internal uint32_t spatialGridHash(int cell_x, int cell_y) {
+    // Two large primes (the classic spatial hash of Teschner et al.); the neighbouring cells end up in the unrelated buckets
+    return (((uint32_t) cell_x * 73856093u) ^ ((uint32_t) cell_y * 19349663u)) & (SPATIAL_GRID_BUCKET_COUNT - 1);
+}
+
 internal void renderDrawLineGradient(Vector2 start, Vector2 end, int thickness, Color a, Color b) {
     for(int i = 0; i < thickness; i++) {
         rlBegin(RL_QUADS);
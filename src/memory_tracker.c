@@ -0,0 +1,90 @@
+// ------------------------------------------------------------------------------
+// Memory tracker (check the 'include/memory_tracker.h')
+// ------------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "memory_tracker.h"
+
+// Size of the header in front of every block (keeps the blocks aligned the same way as the malloc's ones)
+#define MEMORY_TRACKER_HEADER_SIZE 16
+
+static atomic_uint_fast64_t memory_tracker_allocation_count;
+static atomic_uint_fast64_t memory_tracker_allocation_bytes;
+static atomic_uint_fast64_t memory_tracker_free_count;
+static atomic_int_fast64_t memory_tracker_live_bytes;
+
+static void* memoryTrackerRegister(unsigned char* block, size_t size) {
+    if(block == NULL) {
+        return NULL;
+    }
+
+    memcpy(block, &size, sizeof(size));
+
+    atomic_fetch_add_explicit(&memory_tracker_allocation_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&memory_tracker_allocation_bytes, size, memory_order_relaxed);
+    atomic_fetch_add_explicit(&memory_tracker_live_bytes, (int64_t) size, memory_order_relaxed);
+
+    return block + MEMORY_TRACKER_HEADER_SIZE;
+}
+
+void* memoryTrackerMalloc(size_t size) {
+    return memoryTrackerRegister(malloc(size + MEMORY_TRACKER_HEADER_SIZE), size);
+}
+
+void* memoryTrackerCalloc(size_t count, size_t size) {
+    if(size != 0 && count > (SIZE_MAX - MEMORY_TRACKER_HEADER_SIZE) / size) {
+        return NULL;
+    }
+
+    return memoryTrackerRegister(calloc(1, count * size + MEMORY_TRACKER_HEADER_SIZE), count * size);
+}
+
+void* memoryTrackerRealloc(void* pointer, size_t size) {
+    if(pointer == NULL) {
+        return memoryTrackerMalloc(size);
+    }
+
+    unsigned char* block = (unsigned char*) pointer - MEMORY_TRACKER_HEADER_SIZE;
+    size_t size_prev;
+    memcpy(&size_prev, block, sizeof(size_prev));
+
+    unsigned char* result = realloc(block, size + MEMORY_TRACKER_HEADER_SIZE);
+
+    // (On a failure the old block stays where it was, so nothing changes)
+    if(result == NULL) {
+        return NULL;
+    }
+
+    // A reallocation counts as a new allocation of the whole new size (it's what the allocator has to do in the worst case)
+    atomic_fetch_sub_explicit(&memory_tracker_live_bytes, (int64_t) size_prev, memory_order_relaxed);
+    return memoryTrackerRegister(result, size);
+}
+
+void memoryTrackerFree(void* pointer) {
+    if(pointer == NULL) {
+        return;
+    }
+
+    unsigned char* block = (unsigned char*) pointer - MEMORY_TRACKER_HEADER_SIZE;
+    size_t size;
+    memcpy(&size, block, sizeof(size));
+
+    atomic_fetch_add_explicit(&memory_tracker_free_count, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&memory_tracker_live_bytes, (int64_t) size, memory_order_relaxed);
+
+    free(block);
+}
+
+MemoryTrackerStats memoryTrackerGetStats() {
+    MemoryTrackerStats result = {
+        .allocation_count = atomic_load_explicit(&memory_tracker_allocation_count, memory_order_relaxed),
+        .allocation_bytes = atomic_load_explicit(&memory_tracker_allocation_bytes, memory_order_relaxed),
+        .free_count = atomic_load_explicit(&memory_tracker_free_count, memory_order_relaxed),
+        .live_bytes = atomic_load_explicit(&memory_tracker_live_bytes, memory_order_relaxed)
+    };
+
+    return result;
+}
@@ -0,0 +1,1156 @@
+// ------------------------------------------------------------------------------
+// Test harness
+// ------------------------------------------------------------------------------
+// The benchmarks and the soak tests. The harness is the whole game ('src/main.c' is compiled right into it, without its 'main'),
+// so every test can play the real game loop through the 'gameOpen', 'gameFrame' and 'gameClose' (check the 'CMakeLists.txt').
+// ------------------------------------------------------------------------------
+
+#define GAME_HARNESS
+
+#include "../src/main.c"
+
+#include <stddef.h>
+#include <time.h>
+
+#if defined(__linux__)
+    #include <dirent.h>
+
+    // The resident memory and the open handles of the process are read from the '/proc' (sampled by the '--soak-cycles')
+    #define SOAK_PROCESS_STATS
+#endif
+
+#define BENCHMARK_SPLINE_SEGMENTS 100000 // How many spline segments are evaluated by every evaluator in the '--benchmark spline'
+#define BENCHMARK_CORRIDOR_FRAMES 600 // How many frames are rendered by every corridor renderer in the '--benchmark corridor'
+#define BENCHMARK_CORRIDOR_TOLERANCE 0.02f // Maximal fraction of the pixels that can differ in between the CPU and the shader corridor
+#define BENCHMARK_ALLOCATIONS_FRAMES 3600 // How many frames of the 'STATE_GAMEPLAY' the autopilot plays in the '--benchmark allocations'
+
+#define BENCHMARK_REWIND_FRAMES 3600 // How many frames of the 'STATE_GAMEPLAY' the autopilot plays in the '--benchmark rewind'
+#define BENCHMARK_REWIND_BUDGET 100.0 // Maximal average cost of a single rewind snapshot (in microseconds; a tick is ~4166 of them)
+#define BENCHMARK_ENTITIES_TICKS 2400 // How many ticks of the full entity store are simulated in the '--benchmark entities'
+#define BENCHMARK_ENTITIES_CHURN 64 // How many entities are removed and spawned again in every tick of the '--benchmark entities'
+#define BENCHMARK_ENTITIES_BUDGET 100.0 // Maximal average cost of a single tick of the full store (in microseconds; update, pickups and culling)
+#define BENCHMARK_GRID_DENSITY 256 // Entities per screen in the '--benchmark grid' (the world gets longer with more of them, as it would in the game)
+#define BENCHMARK_GRID_QUERIES 100000 // How many player-sized queries are made at every entity count of the '--benchmark grid'
+#define BENCHMARK_GRID_TOLERANCE 2.0 // How many times more the query of the full store can cost than the one of the smallest count
+#define BENCHMARK_LATENCY_FRAMES 1800 // How many frames of the 'STATE_GAMEPLAY' the autopilot plays in every mode of the '--benchmark latency'
+
+#define SOAK_HOURS_DEFAULT 24.0 // Simulated hours of the '--soak' mode, when no other number is given
+#define SOAK_SEED 2024 // Random seed of the '--soak' mode (every soak plays the same corridor)
+#define SOAK_CHUNK_TICKS (SIMULATION_TICK_RATE * 60) // Ticks of every chunk of the '--soak' (its reference run stays below 2^17, check the 'FLOATING_ORIGIN_GRID')
+#define SOAK_FRAME_TIME (1.0f / 30.0f) // Simulated length of a single frame of the '--soak-cycles' (the hidden window renders them as fast as it can)
+#define SOAK_GAME_TIME_MIN 5 // The autopilot of the '--soak-cycles' gives up after a random time in between these two (in seconds)
+#define SOAK_GAME_TIME_MAX 60
+#define SOAK_SAMPLE_COUNT 96 // Samples of the '--soak-cycles', evenly spread over the whole soak (every 15 minutes of the default 24 hours)
+#define SOAK_WARMUP_SAMPLES 4 // The first samples aren't a part of the trend (everything that's allocated once is allocated by then)
+#define SOAK_GROWTH_RSS (1024.0 * 1024.0) // Maximal growth of every trend over the whole soak (in its own unit)
+#define SOAK_GROWTH_LIVE_BYTES 0.0 // (Everything of the game is allocated up front, so the tracked memory must stay flat)
+#define SOAK_GROWTH_ALLOCATIONS 0.0
+#define SOAK_GROWTH_HANDLES 0.5 // (Less than a single handle)
+#define SOAK_GROWTH_FRAME_COST 0.5 // (A fraction of the average frame cost; the wall clock is noisy)
+
+typedef struct {
+    float held_time; // Input of the tick (the reference run replays the autopilot of the rebased one)
+
+    // Positions are the real ones ('origin_x + x'), so both runs can be compared no matter where their origins are
+    double player_x;
+    double camera_x;
+    double obstacle_x[OBSTACLE_CAPACITY];
+    float player_y;
+    float player_velocity_y;
+
+    uint32_t heightfield_hash; // Of the newest obstacle
+    uint32_t points;
+    int entity_count;
+    bool game_over;
+} SoakTick;
+
+typedef struct {
+    // Every chunk of the seeded game is played twice from the same state: with the rebasing, then without it; every tick of the two must match
+    SimulationState* chunk_start;
+    SimulationState* chunk_end; // (Of the rebased run, which continues from it)
+    SoakTick* ticks; // The rebased run's ticks of the chunk, waiting for the reference run
+
+    long long tick_count;
+    int rebase_count;
+    int crash_count;
+    float position_max; // The farthest the rebased run's camera got from its origin
+} Soak;
+
+bool soakRun(double hours);
+SoakTick soakRecordTick(float held_time);
+bool soakCompareTick(SoakTick* expected, SoakTick* actual, long long tick);
+void soakRecover();
+
+typedef struct {
+    double time; // Simulated hours
+    int cycle_count; // Games played so far
+
+    double rss; // Resident memory of the process (in bytes; -1 when it can't be read)
+    double live_bytes; // Bytes allocated through the memory tracker
+    double allocation_count; // Allocations through the memory tracker (all of them, so far)
+    double handle_count; // Open files and sockets of the process (-1 when they can't be counted)
+    double frame_cost; // Averaged wall-clock cost of a single frame since the previous sample (in microseconds)
+} SoakSample;
+
+typedef struct {
+    // Samples of the headless restart cycles; a line fitted through them must stay flat (within the 'SOAK_GROWTH_*')
+    SoakSample samples[SOAK_SAMPLE_COUNT + 1]; // (The last one is taken at the very end)
+    int sample_count;
+
+    int cycle_count;
+    long long frame_count;
+    double frame_cost_total; // Wall-clock cost of the frames since the previous sample (in seconds)
+    long long frame_cost_count;
+} SoakCycles;
+
+bool soakCyclesRun(double hours);
+SoakSample soakCyclesSample(SoakCycles* soak, double time);
+double soakCyclesGetGrowth(SoakCycles* soak, size_t field_offset);
+
+int benchmarkRun(const char* name);
+bool benchmarkSpline();
+bool benchmarkCorridor();
+bool benchmarkAllocations();
+bool benchmarkLatency();
+bool benchmarkRewind();
+bool benchmarkEntities();
+bool benchmarkGrid();
+
+internal InputLatencyReport benchmarkLatencyRun(bool low_latency);
+internal double harnessGetTime();
+internal double soakGetRss();
+internal double soakGetHandleCount();
+
+int main(int argc, char** argv) {
+    GlobalState.spline_basis = splineBasisInit();
+
+    // Modes:
+    // --benchmark <name> - runs the selected benchmark and returns non-zero on failure;
+    // --soak [hours] - plays the given number of hours of the simulation as fast as possible and returns non-zero if it wasn't stable;
+    // --soak-cycles [hours] - restarts the game over and over for the given number of hours and returns non-zero if anything grows;
+    if(argc > 2 && TextIsEqual(argv[1], "--benchmark")) {
+        return benchmarkRun(argv[2]);
+    }
+
+    if(argc > 1 && TextIsEqual(argv[1], "--soak")) {
+        return soakRun(argc > 2 ? atof(argv[2]) : SOAK_HOURS_DEFAULT) ? 0 : 1;
+    }
+
+    if(argc > 1 && TextIsEqual(argv[1], "--soak-cycles")) {
+        return soakCyclesRun(argc > 2 ? atof(argv[2]) : SOAK_HOURS_DEFAULT) ? 0 : 1;
+    }
+
+    TraceLog(LOG_ERROR, "HARNESS: Usage: %s --benchmark <name> | --soak [hours] | --soak-cycles [hours]", argv[0]);
+    return 1;
+}
+
+bool soakRun(double hours) {
+    Soak soak = { 0 };
+
+    // The simulation runs without the window and without the audio (the sounds of the collisions are no-ops),
+    // so a day of the gameplay takes minutes. (There's no rewind, it would only copy the state back and forth)
+    SetRandomSeed(SOAK_SEED);
+    jobSystemInit(&GlobalState.job_system);
+
+    GlobalState.autopilot = autopilotInit(0);
+
+    gameInit();
+    stateMachineSet(STATE_GAMEPLAY);
+    GlobalState.Game.start_key_held = false;
+
+    soak.chunk_start = MemAlloc(sizeof(SimulationState));
+    soak.chunk_end = MemAlloc(sizeof(SimulationState));
+    soak.ticks = MemAlloc(SOAK_CHUNK_TICKS * sizeof(SoakTick));
+
+    long long tick_total = (long long) (hours * 3600.0 * SIMULATION_TICK_RATE);
+    long long tick_report = (long long) 3600 * SIMULATION_TICK_RATE;
+    double start = harnessGetTime();
+    bool result = true;
+
+    TraceLog(LOG_INFO, "SOAK: Playing %.1f hours (%lli ticks), with and without the rebasing", hours, tick_total);
+
+    while(result && soak.tick_count < tick_total) {
+        int chunk_ticks = tick_total - soak.tick_count < SOAK_CHUNK_TICKS ? (int) (tick_total - soak.tick_count) : SOAK_CHUNK_TICKS;
+
+        *soak.chunk_start = GlobalState.simulation;
+
+        for(int tick = 0; tick < chunk_ticks; tick++) {
+            SimulationState* state = &GlobalState.simulation;
+            double origin_x = state->origin_x;
+
+            autopilotUpdate(&GlobalState.autopilot);
+
+            float held_time = GlobalState.autopilot.down ? SIMULATION_STEP : 0.0f;
+
+            simulationTick(held_time);
+            soak.ticks[tick] = soakRecordTick(held_time);
+
+            soak.rebase_count += state->origin_x != origin_x;
+            soak.crash_count += state->player.game_over;
+            soak.position_max = fmaxf(soak.position_max, state->camera.target.x);
+
+            soakRecover();
+        }
+
+        *soak.chunk_end = GlobalState.simulation;
+
+        // The reference: the same chunk with the same input, without the rebasing
+        simulationRestore(soak.chunk_start);
+        GlobalState.floating_origin_disabled = true;
+
+        for(int tick = 0; tick < chunk_ticks && result; tick++) {
+            simulationTick(soak.ticks[tick].held_time);
+
+            SoakTick reference = soakRecordTick(soak.ticks[tick].held_time);
+            result = soakCompareTick(&soak.ticks[tick], &reference, soak.tick_count + tick);
+
+            soakRecover();
+        }
+
+        simulationRestore(soak.chunk_end);
+        GlobalState.floating_origin_disabled = false;
+
+        soak.tick_count += chunk_ticks;
+
+        if(soak.tick_count % tick_report == 0 || soak.tick_count == tick_total || !result) {
+            TraceLog(
+                LOG_INFO, 
+                "SOAK: > %5.1f hours: %i rebases, %i crashes, distance: %.0f, farthest from the origin: %.1f", 
+                soak.tick_count / (3600.0 * SIMULATION_TICK_RATE),
+                soak.rebase_count,
+                soak.crash_count,
+                GlobalState.simulation.origin_x + GlobalState.simulation.camera.target.x,
+                soak.position_max
+            );
+        }
+    }
+
+    TraceLog(LOG_INFO, "SOAK: Done in %.1fs", (harnessGetTime() - start));
+
+    MemFree(soak.chunk_start);
+    MemFree(soak.chunk_end);
+    MemFree(soak.ticks);
+    jobSystemShutdown(&GlobalState.job_system);
+
+    return result;
+}
+
+SoakTick soakRecordTick(float held_time) {
+    SimulationState* state = &GlobalState.simulation;
+    Obstacle* obstacle_last = &state->obstacle_list.list[OBSTACLE_CAPACITY - 1];
+
+    SoakTick result = {
+        .held_time = held_time,
+        .player_x = state->origin_x + state->player.position.x,
+        .camera_x = state->origin_x + state->camera.target.x,
+        .player_y = state->player.position.y,
+        .player_velocity_y = state->player.velocity.y,
+        .heightfield_hash = 2166136261u,
+        .points = state->player.points,
+        .entity_count = state->entities.count,
+        .game_over = state->player.game_over
+    };
+
+    for(int i = 0; i < OBSTACLE_CAPACITY; i++) {
+        result.obstacle_x[i] = state->origin_x + state->obstacle_list.list[i].position.x;
+    }
+
+    // FNV-1a of the heightfield the collisions are read from (it's built from the spline in the obstacle's own coordinates)
+    const unsigned char* bytes = (const unsigned char*) obstacle_last->height0;
+
+    for(size_t i = 0; i < sizeof(obstacle_last->height0) + sizeof(obstacle_last->height1); i++) {
+        result.heightfield_hash = (result.heightfield_hash ^ bytes[i]) * 16777619u;
+    }
+
+    return result;
+}
+
+bool soakCompareTick(SoakTick* expected, SoakTick* actual, long long tick) {
+    bool obstacles_equal = true;
+
+    for(int i = 0; i < OBSTACLE_CAPACITY; i++) {
+        obstacles_equal = obstacles_equal && expected->obstacle_x[i] == actual->obstacle_x[i];
+    }
+
+    const char* mismatch = 
+        expected->player_x != actual->player_x ? "player's x" :
+        expected->player_y != actual->player_y ? "player's y" :
+        expected->player_velocity_y != actual->player_velocity_y ? "player's velocity" :
+        expected->camera_x != actual->camera_x ? "camera" :
+        !obstacles_equal ? "obstacles" :
+        expected->heightfield_hash != actual->heightfield_hash ? "heightfield" :
+        expected->game_over != actual->game_over ? "collision (game over)" :
+        expected->points != actual->points || expected->entity_count != actual->entity_count ? "collision (pickups)" :
+        NULL;
+
+    if(!mismatch) {
+        return true;
+    }
+
+    TraceLog(
+        LOG_ERROR, 
+        "SOAK: The rebased run doesn't match the reference at the tick %lli (%.1f hours): %s (player: %.4f, %.4f vs %.4f, %.4f, camera: %.4f vs %.4f)", 
+        tick,
+        tick / (3600.0 * SIMULATION_TICK_RATE),
+        mismatch,
+        expected->player_x, expected->player_y, actual->player_x, actual->player_y,
+        expected->camera_x, actual->camera_x
+    );
+
+    return false;
+}
+
+void soakRecover() {
+    SimulationState* state = &GlobalState.simulation;
+
+    // A crash puts the player back into the middle of the corridor (the run continues, so the world keeps growing)
+    if(!state->player.game_over) {
+        return;
+    }
+
+    float corridor_top = 0.0f;
+    float corridor_bottom = worldGetSize().y;
+
+    obstacleListGetCorridor(state->player.position.x, state->player.position.x + OBSTACLE_HEIGHTFIELD_STEP, &corridor_top, &corridor_bottom);
+
+    state->player.position.y = (corridor_top + corridor_bottom) / 2.0f;
+    state->player.velocity.y = 0.0f;
+    state->player.game_over = false;
+}
+
+bool soakCyclesRun(double hours) {
+    SoakCycles soak = { 0 };
+
+    // The whole game runs in the hidden window: the same loop, render textures, freeze frame, frame arena, music and resources.
+    // The autopilot plays it faster than the real time and gives up after a while, so the game keeps restarting.
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    SetRandomSeed(SOAK_SEED);
+
+    GlobalState.Game.low_latency = true; // (Without the V-Sync, so the frames aren't waiting for the display)
+    GlobalState.autopilot = autopilotInit(0);
+    GlobalState.autopilot.frame_time = SOAK_FRAME_TIME;
+    GlobalState.autopilot.give_up_frames_min = (int) (SOAK_GAME_TIME_MIN / SOAK_FRAME_TIME);
+    GlobalState.autopilot.give_up_frames_max = (int) (SOAK_GAME_TIME_MAX / SOAK_FRAME_TIME);
+    GlobalState.autopilot.random = randomInit(SOAK_SEED);
+
+    gameOpen();
+
+    long long frame_total = (long long) (hours * 3600.0 / SOAK_FRAME_TIME);
+    long long frame_sample = frame_total / SOAK_SAMPLE_COUNT > 0 ? frame_total / SOAK_SAMPLE_COUNT : 1;
+    int state_prev = GlobalState.Game.gameplay_state_machine;
+    bool finished = false;
+
+    TraceLog(LOG_INFO, "SOAK: Playing %.1f hours of restarts (%lli frames)", hours, frame_total);
+
+    while(!WindowShouldClose()) {
+        // (The welcome screen is loading the resources, it isn't a part of the soak)
+        bool loaded = GlobalState.Game.gameplay_state_machine != STATE_WELCOME_SCREEN;
+
+        if(loaded && (soak.frame_count % frame_sample == 0 || soak.frame_count == frame_total)) {
+            SoakSample* sample = &soak.samples[soak.sample_count++];
+            *sample = soakCyclesSample(&soak, soak.frame_count * SOAK_FRAME_TIME / 3600.0);
+
+            TraceLog(
+                LOG_INFO, 
+                "SOAK: > %5.1f hours: %6i games, RSS: %7.2f MB, tracked: %10.0f B live (%6.0f allocations), %3.0f handles, %7.2f us / frame",
+                sample->time,
+                sample->cycle_count,
+                sample->rss / (1024.0 * 1024.0),
+                sample->live_bytes,
+                sample->allocation_count,
+                sample->handle_count,
+                sample->frame_cost
+            );
+
+            finished = soak.frame_count == frame_total || soak.sample_count == SOAK_SAMPLE_COUNT + 1;
+
+            if(finished) {
+                break;
+            }
+        }
+
+        double frame_start = harnessGetTime();
+
+        gameFrame();
+
+        if(loaded) {
+            soak.frame_cost_total += harnessGetTime() - frame_start;
+            soak.frame_cost_count++;
+            soak.frame_count++;
+        }
+
+        if(GlobalState.Game.gameplay_state_machine == STATE_GAMEOVER && state_prev != STATE_GAMEOVER) {
+            soak.cycle_count++;
+        }
+
+        state_prev = GlobalState.Game.gameplay_state_machine;
+    }
+
+    gameClose();
+
+    if(!finished) {
+        TraceLog(LOG_ERROR, "SOAK: The game was closed before the soak finished");
+        return false;
+    }
+
+    // The trends: fitted growth over the whole soak (the unavailable quantities are skipped)
+    double frame_cost_average = 0.0;
+
+    for(int i = SOAK_WARMUP_SAMPLES; i < soak.sample_count; i++) {
+        frame_cost_average += soak.samples[i].frame_cost / (soak.sample_count - SOAK_WARMUP_SAMPLES);
+    }
+
+    const char* trend_names[5] = { "RSS (B)", "tracked memory (B)", "allocations", "handles", "frame cost (us)" };
+    size_t trend_offsets[5] = { offsetof(SoakSample, rss), offsetof(SoakSample, live_bytes), offsetof(SoakSample, allocation_count), offsetof(SoakSample, handle_count), offsetof(SoakSample, frame_cost) };
+    double trend_limits[5] = { SOAK_GROWTH_RSS, SOAK_GROWTH_LIVE_BYTES, SOAK_GROWTH_ALLOCATIONS, SOAK_GROWTH_HANDLES, SOAK_GROWTH_FRAME_COST * frame_cost_average };
+    bool result = true;
+
+    if(soak.sample_count < SOAK_WARMUP_SAMPLES + 3) {
+        TraceLog(LOG_ERROR, "SOAK: The soak is too short to have a trend (%i samples)", soak.sample_count);
+        return false;
+    }
+
+    TraceLog(LOG_INFO, "SOAK: %i games in %.1f hours, growth over the whole soak:", soak.cycle_count, hours);
+
+    for(int i = 0; i < 5; i++) {
+        double first = *(double*) ((char*) &soak.samples[SOAK_WARMUP_SAMPLES] + trend_offsets[i]);
+
+        if(first < 0.0) {
+            TraceLog(LOG_INFO, "SOAK: > %-20s not available on this platform", trend_names[i]);
+            continue;
+        }
+
+        double growth = soakCyclesGetGrowth(&soak, trend_offsets[i]);
+        bool growing = growth > trend_limits[i];
+
+        TraceLog(growing ? LOG_ERROR : LOG_INFO, "SOAK: > %-20s %12.2f (limit: %.2f)%s", trend_names[i], growth, trend_limits[i], growing ? " - GROWING" : "");
+        result = result && !growing;
+    }
+
+    return result;
+}
+
+SoakSample soakCyclesSample(SoakCycles* soak, double time) {
+    MemoryTrackerStats memory = memoryTrackerGetStats();
+
+    SoakSample result = {
+        .time = time,
+        .cycle_count = soak->cycle_count,
+        .rss = soakGetRss(),
+        .live_bytes = (double) memory.live_bytes,
+        .allocation_count = (double) memory.allocation_count,
+        .handle_count = soakGetHandleCount(),
+        .frame_cost = soak->frame_cost_count > 0 ? soak->frame_cost_total / soak->frame_cost_count * 1000000.0 : 0.0
+    };
+
+    soak->frame_cost_total = 0.0;
+    soak->frame_cost_count = 0;
+
+    return result;
+}
+
+double soakCyclesGetGrowth(SoakCycles* soak, size_t field_offset) {
+    // Least-squares line through the samples after the warm-up; its slope over their time span is the growth.
+    // (The values are taken relatively to the first one, so a flat line comes out exactly flat, without any rounding noise)
+    double baseline = *(double*) ((char*) &soak->samples[SOAK_WARMUP_SAMPLES] + field_offset);
+    double time_mean = 0.0;
+    double value_mean = 0.0;
+    int count = soak->sample_count - SOAK_WARMUP_SAMPLES;
+
+    for(int i = SOAK_WARMUP_SAMPLES; i < soak->sample_count; i++) {
+        time_mean += soak->samples[i].time;
+        value_mean += *(double*) ((char*) &soak->samples[i] + field_offset) - baseline;
+    }
+
+    time_mean /= count;
+    value_mean /= count;
+
+    double covariance = 0.0;
+    double variance = 0.0;
+
+    for(int i = SOAK_WARMUP_SAMPLES; i < soak->sample_count; i++) {
+        double time = soak->samples[i].time - time_mean;
+        double value = *(double*) ((char*) &soak->samples[i] + field_offset) - baseline - value_mean;
+
+        covariance += time * value;
+        variance += time * time;
+    }
+
+    if(variance <= 0.0) {
+        return 0.0;
+    }
+
+    return covariance / variance * (soak->samples[soak->sample_count - 1].time - soak->samples[SOAK_WARMUP_SAMPLES].time);
+}
+
+internal double harnessGetTime() {
+    // Monotonic, with the nanosecond resolution (the raylib's timer needs the window, and the 'clock' is too coarse for the short loops)
+    struct timespec time;
+
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &time);
+#else
+    timespec_get(&time, TIME_UTC);
+#endif
+
+    return time.tv_sec + time.tv_nsec / 1000000000.0;
+}
+
+internal double soakGetRss() {
+#if defined(SOAK_PROCESS_STATS)
+    FILE* file = fopen("/proc/self/statm", "r");
+    long pages = -1;
+
+    if(!file) {
+        return -1.0;
+    }
+
+    // (Total program size, then the resident set - both in pages)
+    if(fscanf(file, "%*s %ld", &pages) != 1) {
+        pages = -1;
+    }
+
+    fclose(file);
+    return pages < 0 ? -1.0 : (double) pages * sysconf(_SC_PAGESIZE);
+#else
+    return -1.0;
+#endif
+}
+
+internal double soakGetHandleCount() {
+#if defined(SOAK_PROCESS_STATS)
+    DIR* directory = opendir("/proc/self/fd");
+    int count = 0;
+
+    if(!directory) {
+        return -1.0;
+    }
+
+    for(struct dirent* entry = readdir(directory); entry; entry = readdir(directory)) {
+        if(entry->d_name[0] != '.') {
+            count++;
+        }
+    }
+
+    closedir(directory);
+
+    // (The directory itself is open while it's being read)
+    return count - 1;
+#else
+    return -1.0;
+#endif
+}
+
+int benchmarkRun(const char* name) {
+    if(TextIsEqual(name, "spline")) {
+        return benchmarkSpline() ? 0 : 1;
+    }
+
+    if(TextIsEqual(name, "corridor")) {
+        return benchmarkCorridor() ? 0 : 1;
+    }
+
+    if(TextIsEqual(name, "allocations")) {
+        return benchmarkAllocations() ? 0 : 1;
+    }
+
+    if(TextIsEqual(name, "latency")) {
+        return benchmarkLatency() ? 0 : 1;
+    }
+
+    if(TextIsEqual(name, "rewind")) {
+        return benchmarkRewind() ? 0 : 1;
+    }
+
+    if(TextIsEqual(name, "entities")) {
+        return benchmarkEntities() ? 0 : 1;
+    }
+
+    if(TextIsEqual(name, "grid")) {
+        return benchmarkGrid() ? 0 : 1;
+    }
+
+    TraceLog(LOG_ERROR, "BENCHMARK: Unknown benchmark: %s", name);
+    return 1;
+}
+
+bool benchmarkSpline() {
+    const float TOLERANCE = 0.05f; // Maximal allowed difference from the exact (double-precision) spline (in world units, well below a pixel)
+
+    SplineBasis* basis = &GlobalState.spline_basis;
+    Random random = randomInit(1);
+
+    Vector2 samples[SPLINE_SEGMENT_RESOLUTION + 1];
+    Vector2 samples_exact[SPLINE_SEGMENT_RESOLUTION + 1];
+
+    // Control points of every segment (p1, c2, c3, p4), generated up front, so only the evaluation is timed
+    Vector2* segments = MemAlloc(BENCHMARK_SPLINE_SEGMENTS * 4 * sizeof(Vector2));
+
+    float error_raylib = 0.0f;
+    float error_basis = 0.0f;
+    float error_forward = 0.0f;
+
+    // (The checksum keeps the compiler from optimizing the evaluation away)
+    float checksum = 0.0f;
+
+    for(int segment = 0; segment < BENCHMARK_SPLINE_SEGMENTS; segment++) {
+        // Segments that look like the ones of our corridor: horizontal handles and 'OBSTACLE_WIDTH' long
+        Vector2* points = &segments[segment * 4];
+
+        points[0] = (Vector2) { randomGetValue(&random, 0, 1 << 16), randomGetValue(&random, 0, WORLD_HEIGHT) };
+        points[3] = (Vector2) { points[0].x + OBSTACLE_WIDTH, randomGetValue(&random, 0, WORLD_HEIGHT) };
+        points[1] = (Vector2) { points[0].x + OBSTACLE_WIDTH / 2.0f, points[0].y };
+        points[2] = (Vector2) { points[3].x - OBSTACLE_WIDTH / 2.0f, points[3].y };
+    }
+
+    // The precision: every evaluator against the exact (double-precision) samples
+    for(int segment = 0; segment < BENCHMARK_SPLINE_SEGMENTS; segment++) {
+        Vector2* points = &segments[segment * 4];
+
+        for(int i = 0; i <= SPLINE_SEGMENT_RESOLUTION; i++) {
+            double t = i / (double) SPLINE_SEGMENT_RESOLUTION;
+            double u = 1.0 - t;
+
+            samples_exact[i].x = u * u * u * points[0].x + 3.0 * t * u * u * points[1].x + 3.0 * t * t * u * points[2].x + t * t * t * points[3].x;
+            samples_exact[i].y = u * u * u * points[0].y + 3.0 * t * u * u * points[1].y + 3.0 * t * t * u * points[2].y + t * t * t * points[3].y;
+        }
+
+        for(int i = 0; i <= SPLINE_SEGMENT_RESOLUTION; i++) {
+            samples[i] = GetSplinePointBezierCubic(points[0], points[1], points[2], points[3], i / (float) SPLINE_SEGMENT_RESOLUTION);
+            error_raylib = fmaxf(error_raylib, Vector2Distance(samples[i], samples_exact[i]));
+        }
+
+        splineEvaluateBasis(basis, points[0], points[1], points[2], points[3], samples);
+
+        for(int i = 0; i <= SPLINE_SEGMENT_RESOLUTION; i++) {
+            error_basis = fmaxf(error_basis, Vector2Distance(samples[i], samples_exact[i]));
+        }
+
+        splineEvaluateForward(points[0], points[1], points[2], points[3], samples);
+
+        for(int i = 0; i <= SPLINE_SEGMENT_RESOLUTION; i++) {
+            error_forward = fmaxf(error_forward, Vector2Distance(samples[i], samples_exact[i]));
+        }
+    }
+
+    // The speed: every evaluator is timed once over all the segments (a single segment is only about a microsecond of work)
+    double start = harnessGetTime();
+
+    for(int segment = 0; segment < BENCHMARK_SPLINE_SEGMENTS; segment++) {
+        Vector2* points = &segments[segment * 4];
+
+        for(int i = 0; i <= SPLINE_SEGMENT_RESOLUTION; i++) {
+            samples[i] = GetSplinePointBezierCubic(points[0], points[1], points[2], points[3], i / (float) SPLINE_SEGMENT_RESOLUTION);
+        }
+
+        checksum += samples[segment % SPLINE_SEGMENT_RESOLUTION].y;
+    }
+
+    double time_raylib = harnessGetTime() - start;
+    start = harnessGetTime();
+
+    for(int segment = 0; segment < BENCHMARK_SPLINE_SEGMENTS; segment++) {
+        Vector2* points = &segments[segment * 4];
+
+        splineEvaluateBasis(basis, points[0], points[1], points[2], points[3], samples);
+        checksum += samples[segment % SPLINE_SEGMENT_RESOLUTION].y;
+    }
+
+    double time_basis = harnessGetTime() - start;
+    start = harnessGetTime();
+
+    for(int segment = 0; segment < BENCHMARK_SPLINE_SEGMENTS; segment++) {
+        Vector2* points = &segments[segment * 4];
+
+        splineEvaluateForward(points[0], points[1], points[2], points[3], samples);
+        checksum += samples[segment % SPLINE_SEGMENT_RESOLUTION].y;
+    }
+
+    double time_forward = harnessGetTime() - start;
+
+    MemFree(segments);
+
+    const double SAMPLE_COUNT = (double) BENCHMARK_SPLINE_SEGMENTS * (SPLINE_SEGMENT_RESOLUTION + 1);
+
+    TraceLog(LOG_INFO, "BENCHMARK: Spline evaluation (%i segments, %i samples each, checksum: %.1f)", BENCHMARK_SPLINE_SEGMENTS, SPLINE_SEGMENT_RESOLUTION + 1, checksum);
+    TraceLog(LOG_INFO, "BENCHMARK: > GetSplinePointBezierCubic: %8.2f ms (%.2f ns / sample, max. error: %f)", time_raylib * 1000.0, time_raylib * 1e9 / SAMPLE_COUNT, error_raylib);
+    TraceLog(LOG_INFO, "BENCHMARK: > splineEvaluateBasis:       %8.2f ms (%.2f ns / sample, max. error: %f)", time_basis * 1000.0, time_basis * 1e9 / SAMPLE_COUNT, error_basis);
+    TraceLog(LOG_INFO, "BENCHMARK: > splineEvaluateForward:     %8.2f ms (%.2f ns / sample, max. error: %f)", time_forward * 1000.0, time_forward * 1e9 / SAMPLE_COUNT, error_forward);
+
+    if(error_basis > TOLERANCE || error_forward > TOLERANCE) {
+        TraceLog(LOG_ERROR, "BENCHMARK: Spline evaluators are out of the tolerance (%f)", TOLERANCE);
+        return false;
+    }
+
+    return true;
+}
+
+bool benchmarkCorridor() {
+    // The renderers need the OpenGL context, but nothing has to be visible.
+    // (With Mesa it can be verified on the software implementation as well: 'LIBGL_ALWAYS_SOFTWARE=1 game --benchmark corridor')
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(worldGetSize().x, worldGetSize().y, TextFormat("%s - corridor benchmark", GAME_TITLE));
+
+    bool result = true;
+
+    GlobalState.corridor_renderer = corridorRendererInit();
+
+    if(!GlobalState.corridor_renderer.ready) {
+        TraceLog(LOG_ERROR, "BENCHMARK: Corridor shader failed to compile");
+        CloseWindow();
+        return false;
+    }
+
+    jobSystemInit(&GlobalState.job_system);
+
+    GlobalState.simulation.camera = (Camera2D) {
+        .offset = { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f },
+        .target = { worldGetSize().x / 2.0f, worldGetSize().y / 2.0f},
+        .zoom = 1.0f
+    };
+
+    GlobalState.simulation.obstacle_list = obstacleListInit(&GlobalState.simulation.entities);
+    GlobalState.frame_arena = frameArenaInit(FRAME_ARENA_CAPACITY);
+
+    // '0' - CPU renderer, '1' - shader renderer
+    RenderTexture2D targets[2] = {
+        LoadRenderTexture(worldGetSize().x, worldGetSize().y),
+        LoadRenderTexture(worldGetSize().x, worldGetSize().y)
+    };
+
+    double times[2] = { 0 };
+    int pixels_compared = 0;
+    int pixels_different = 0;
+
+    for(int frame = 0; frame < BENCHMARK_CORRIDOR_FRAMES; frame++) {
+        GlobalState.simulation.camera.target.x += PLAYER_SPEED / RENDER_SCALE_TARGET_FPS;
+        obstacleListLoopObstacles();
+        frameArenaReset(&GlobalState.frame_arena);
+        GlobalState.visibility = renderVisibilityBuild(&GlobalState.frame_arena, renderGetWorldBounds());
+
+        for(int renderer = 0; renderer < 2; renderer++) {
+            double start = GetTime();
+
+            BeginTextureMode(targets[renderer]);
+            ClearBackground(BLANK);
+            BeginMode2D(GlobalState.simulation.camera);
+
+                if(renderer == 0) {
+                    obstacleListRenderWalls();
+                } else {
+                    corridorRendererRender(&GlobalState.corridor_renderer);
+                }
+
+            EndMode2D();
+            EndTextureMode();
+
+            // (The time of building and submitting the geometry; the GPU keeps working asynchronously)
+            times[renderer] += GetTime() - start;
+        }
+
+        // Every second the frames are read back and compared pixel by pixel
+        if(frame % (int) RENDER_SCALE_TARGET_FPS == 0) {
+            Image images[2] = {
+                LoadImageFromTexture(targets[0].texture),
+                LoadImageFromTexture(targets[1].texture)
+            };
+
+            for(int y = 0; y < images[0].height; y += 2) {
+                for(int x = 0; x < images[0].width; x += 2) {
+                    Color color0 = GetImageColor(images[0], x, y);
+                    Color color1 = GetImageColor(images[1], x, y);
+
+                    // (A small difference on the gradients and the anti-aliased edges is fine)
+                    const int CHANNEL_TOLERANCE = 48;
+
+                    bool different = 
+                        abs(color0.r - color1.r) > CHANNEL_TOLERANCE || 
+                        abs(color0.g - color1.g) > CHANNEL_TOLERANCE || 
+                        abs(color0.b - color1.b) > CHANNEL_TOLERANCE || 
+                        abs(color0.a - color1.a) > CHANNEL_TOLERANCE;
+
+                    pixels_compared++;
+                    pixels_different += different;
+                }
+            }
+
+            UnloadImage(images[0]);
+            UnloadImage(images[1]);
+        }
+    }
+
+    float difference = pixels_compared > 0 ? (float) pixels_different / pixels_compared : 1.0f;
+
+    TraceLog(LOG_INFO, "BENCHMARK: Corridor rendering (%i frames, %ix%i)", BENCHMARK_CORRIDOR_FRAMES, (int) worldGetSize().x, (int) worldGetSize().y);
+    TraceLog(LOG_INFO, "BENCHMARK: > CPU renderer:    %8.3f ms / frame", times[0] * 1000.0 / BENCHMARK_CORRIDOR_FRAMES);
+    TraceLog(LOG_INFO, "BENCHMARK: > Shader renderer: %8.3f ms / frame", times[1] * 1000.0 / BENCHMARK_CORRIDOR_FRAMES);
+    TraceLog(LOG_INFO, "BENCHMARK: > Different pixels: %.2f%%", difference * 100.0f);
+
+    if(difference > BENCHMARK_CORRIDOR_TOLERANCE) {
+        TraceLog(LOG_ERROR, "BENCHMARK: Corridor renderers don't match (tolerance: %.2f%%)", BENCHMARK_CORRIDOR_TOLERANCE * 100.0f);
+        result = false;
+    }
+
+    UnloadRenderTexture(targets[0]);
+    UnloadRenderTexture(targets[1]);
+
+    jobSystemShutdown(&GlobalState.job_system);
+    corridorRendererUnload(&GlobalState.corridor_renderer);
+    frameArenaUnload(&GlobalState.frame_arena);
+    CloseWindow();
+
+    return result;
+}
+
+bool benchmarkAllocations() {
+    // The whole game runs in the hidden window, and the autopilot plays it (check the 'Autopilot').
+    // Nothing in the 'STATE_GAMEPLAY' is supposed to allocate: the resources are loaded by the welcome screen,
+    // the obstacles and the particles live in the fixed-size buffers, and all the transient data goes through the frame arena.
+#if !defined(MEMORY_TRACKER_ENABLED)
+    TraceLog(LOG_ERROR, "BENCHMARK: The game was built without the memory tracker (check the 'GAME_MEMORY_TRACKER' option)");
+    return false;
+#endif
+
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    GlobalState.autopilot = autopilotInit(BENCHMARK_ALLOCATIONS_FRAMES);
+
+    gameRun();
+
+    MemoryStats* stats = &GlobalState.Debug.memory;
+    const char* state_names[STATE_COUNT] = { "STATE_WELCOME_SCREEN", "STATE_START", "STATE_GAMEPLAY", "STATE_GAMEOVER", "STATE_PAUSE", "STATE_RESUME" };
+
+    TraceLog(LOG_INFO, "BENCHMARK: Allocations (%i gameplay frames played by the autopilot)", GlobalState.autopilot.gameplay_frames);
+
+    for(int state = 0; state < STATE_COUNT; state++) {
+        TraceLog(
+            LOG_INFO, 
+            "BENCHMARK: > %-20s %6llu frames, %8llu allocations, %10llu bytes", 
+            state_names[state], 
+            (unsigned long long) stats->state_frames[state], 
+            (unsigned long long) stats->state_allocations[state], 
+            (unsigned long long) stats->state_bytes[state]
+        );
+    }
+
+    if(GlobalState.autopilot.gameplay_frames < BENCHMARK_ALLOCATIONS_FRAMES) {
+        TraceLog(LOG_ERROR, "BENCHMARK: The game was closed before the autopilot finished");
+        return false;
+    }
+
+    if(stats->state_allocations[STATE_GAMEPLAY] > 0) {
+        TraceLog(LOG_ERROR, "BENCHMARK: STATE_GAMEPLAY allocates (%llu allocations)", (unsigned long long) stats->state_allocations[STATE_GAMEPLAY]);
+        return false;
+    }
+
+    return true;
+}
+
+bool benchmarkLatency() {
+    // The autopilot plays the same game in both modes; its button is timestamped and measured the same way as the real one.
+    // (The hidden window might not be synchronized by every driver, so the difference is the most visible in a normal window)
+    InputLatencyReport reports[2] = {
+        benchmarkLatencyRun(false),
+        benchmarkLatencyRun(true)
+    };
+
+    const char* mode_names[2] = { "V-Sync     ", "low-latency" };
+
+    TraceLog(LOG_INFO, "BENCHMARK: Input-to-present latency (%i gameplay frames per mode)", BENCHMARK_LATENCY_FRAMES);
+
+    for(int i = 0; i < 2; i++) {
+        TraceLog(LOG_INFO, "BENCHMARK: > %s p50: %6.2f ms, p95: %6.2f ms, p99: %6.2f ms (%i events)", mode_names[i], reports[i].p50, reports[i].p95, reports[i].p99, reports[i].count);
+    }
+
+    if(reports[0].count == 0 || reports[1].count == 0) {
+        TraceLog(LOG_ERROR, "BENCHMARK: No input events were measured");
+        return false;
+    }
+
+    return true;
+}
+
+internal InputLatencyReport benchmarkLatencyRun(bool low_latency) {
+    // Every run starts from the clean state (the game doesn't expect to be initialized twice)
+    memset(&GlobalState, 0, sizeof(GlobalState));
+    GlobalState.spline_basis = splineBasisInit();
+    GlobalState.Game.low_latency = low_latency;
+    GlobalState.autopilot = autopilotInit(BENCHMARK_LATENCY_FRAMES);
+
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    gameRun();
+
+    // (The frame arena is gone with the game, so the percentiles are sorted in a temporary one)
+    FrameArena arena = frameArenaInit(sizeof(GlobalState.Game.input_queue.latencies));
+    InputLatencyReport result = inputQueueGetLatency(&GlobalState.Game.input_queue, &arena);
+    frameArenaUnload(&arena);
+
+    return result;
+}
+
+bool benchmarkRewind() {
+    // The autopilot plays the game, and every one of its ticks is snapshotted into the rewind ring (exactly as in the normal game).
+    // The snapshot is taken 'SIMULATION_TICK_RATE' times a second, so it has to stay in the microseconds.
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    GlobalState.autopilot = autopilotInit(BENCHMARK_REWIND_FRAMES);
+
+    gameRun();
+
+    Rewind* rewind = &GlobalState.rewind;
+
+    TraceLog(LOG_INFO, "BENCHMARK: Rewind (%i gameplay frames played by the autopilot)", GlobalState.autopilot.gameplay_frames);
+    TraceLog(LOG_INFO, "BENCHMARK: > Simulation state: %i B", (int) sizeof(SimulationState));
+    TraceLog(LOG_INFO, "BENCHMARK: > Snapshot: %.2f us (averaged), %.2f us (max)", rewind->push_cost, rewind->push_cost_max);
+    TraceLog(
+        LOG_INFO, 
+        "BENCHMARK: > History: %i ticks (%.1fs) in %i B (%.1f B / tick)", 
+        rewind->record_count, 
+        rewind->record_count * SIMULATION_STEP, 
+        (int) (rewind->buffer_used * sizeof(uint32_t)),
+        rewind->record_count > 0 ? (float) rewind->buffer_used * sizeof(uint32_t) / rewind->record_count : 0.0f
+    );
+
+    if(GlobalState.autopilot.gameplay_frames < BENCHMARK_REWIND_FRAMES) {
+        TraceLog(LOG_ERROR, "BENCHMARK: The game was closed before the autopilot finished");
+        return false;
+    }
+
+    if(rewind->push_cost > BENCHMARK_REWIND_BUDGET) {
+        TraceLog(LOG_ERROR, "BENCHMARK: The snapshot is over the budget (%.2f us > %.2f us)", rewind->push_cost, BENCHMARK_REWIND_BUDGET);
+        return false;
+    }
+
+    return true;
+}
+
+bool benchmarkEntities() {
+    // The store is filled up to the 'ENTITY_CAPACITY' with the entities scattered over the screen, and every tick runs exactly what the gameplay does with them
+    // (the update, the pickups - the grid build and a player-sized query - and the culling against the screen), plus some churn through the handles and the free-list.
+    // The picked up entities aren't removed (so the store stays full), and the handles are checked against the store after every tick.
+    EntityStore* store = MemAlloc(sizeof(EntityStore));
+    SpatialGrid* grid = MemAlloc(sizeof(SpatialGrid));
+    EntityHandle* handles = MemAlloc(sizeof(EntityHandle) * ENTITY_CAPACITY);
+    int* visible = MemAlloc(sizeof(int) * ENTITY_CAPACITY);
+    Random random = randomInit(1);
+
+    Rectangle bounds = { 0.0f, 0.0f, worldGetSize().x, worldGetSize().y };
+
+    double time_update = 0.0;
+    double time_pickups = 0.0;
+    double time_cull = 0.0;
+    long long checksum = 0;
+    bool valid = true;
+
+    for(int i = 0; i < ENTITY_CAPACITY; i++) {
+        Entity entity = {
+            .position = { randomGetValue(&random, -256, WORLD_WIDTH + 256), randomGetValue(&random, -256, WORLD_HEIGHT + 256) },
+            .velocity = { randomGetValue(&random, -64, 64), randomGetValue(&random, -64, 64) },
+            .radius = COLLECTLIBLE_RADIUS,
+            .type = randomGetValue(&random, 0, ENTITY_TYPE_COUNT - 1)
+        };
+
+        handles[i] = entityStoreAdd(store, entity);
+    }
+
+    for(int tick = 0; tick < BENCHMARK_ENTITIES_TICKS && valid; tick++) {
+        // Churn: a few random entities are removed, and the new ones take their slots (the old handles must stop working)
+        for(int i = 0; i < BENCHMARK_ENTITIES_CHURN; i++) {
+            int victim = randomGetValue(&random, 0, ENTITY_CAPACITY - 1);
+            EntityHandle handle_old = handles[victim];
+            int index = entityStoreFind(store, handle_old);
+
+            Entity entity = {
+                .position = store->position[index],
+                .velocity = store->velocity[index],
+                .radius = store->radius[index],
+                .type = store->type[index]
+            };
+
+            entityStoreRemove(store, handle_old);
+            handles[victim] = entityStoreAdd(store, entity);
+
+            valid &= entityStoreFind(store, handle_old) == -1;
+        }
+
+        double start = harnessGetTime();
+        entityStoreUpdate(store, SIMULATION_STEP);
+        time_update += (harnessGetTime() - start);
+
+        // (The player crosses the screen at its speed and bobs up and down, so there's always something to pick up)
+        Rectangle player_rect = { 
+            fmodf(tick * PLAYER_SPEED * SIMULATION_STEP, worldGetSize().x), 
+            worldGetSize().y / 2.0f + sinf(tick * SIMULATION_STEP) * worldGetSize().y / 4.0f, 
+            64.0f, 
+            64.0f 
+        };
+
+        // (The same as the 'simulationTick' and the 'playerCheckCollisions': the grid is rebuilt, then the player's rectangle is looked up in it)
+        int hits[SPATIAL_GRID_QUERY_CAPACITY];
+
+        start = harnessGetTime();
+        spatialGridBuild(grid, store);
+        checksum += spatialGridQuery(grid, player_rect, hits, SPATIAL_GRID_QUERY_CAPACITY);
+        time_pickups += (harnessGetTime() - start);
+
+        start = harnessGetTime();
+        checksum += entityStoreCull(store, bounds, visible);
+        time_cull += (harnessGetTime() - start);
+
+        for(int i = 0; i < ENTITY_CAPACITY; i++) {
+            int index = entityStoreFind(store, handles[i]);
+            valid &= index >= 0 && index < store->count && store->slot[index] == (handles[i] & 0xFFFF);
+        }
+    }
+
+    double time_tick = (time_update + time_pickups + time_cull) * 1000000.0 / BENCHMARK_ENTITIES_TICKS;
+
+    TraceLog(LOG_INFO, "BENCHMARK: Entities (%i entities, %i ticks, %i churned per tick, checksum: %lli)", store->count, BENCHMARK_ENTITIES_TICKS, BENCHMARK_ENTITIES_CHURN, checksum);
+    TraceLog(LOG_INFO, "BENCHMARK: > Entity store: %i B", (int) sizeof(EntityStore));
+    TraceLog(LOG_INFO, "BENCHMARK: > Update:  %8.2f us / tick (%.2f ns / entity)", time_update * 1000000.0 / BENCHMARK_ENTITIES_TICKS, time_update * 1e9 / BENCHMARK_ENTITIES_TICKS / ENTITY_CAPACITY);
+    TraceLog(LOG_INFO, "BENCHMARK: > Pickups: %8.2f us / tick (%.2f ns / entity)", time_pickups * 1000000.0 / BENCHMARK_ENTITIES_TICKS, time_pickups * 1e9 / BENCHMARK_ENTITIES_TICKS / ENTITY_CAPACITY);
+    TraceLog(LOG_INFO, "BENCHMARK: > Culling: %8.2f us / tick (%.2f ns / entity)", time_cull * 1000000.0 / BENCHMARK_ENTITIES_TICKS, time_cull * 1e9 / BENCHMARK_ENTITIES_TICKS / ENTITY_CAPACITY);
+
+    MemFree(visible);
+    MemFree(handles);
+    MemFree(grid);
+    MemFree(store);
+
+    if(!valid) {
+        TraceLog(LOG_ERROR, "BENCHMARK: The entity handles don't match the store");
+        return false;
+    }
+
+    if(time_tick > BENCHMARK_ENTITIES_BUDGET) {
+        TraceLog(LOG_ERROR, "BENCHMARK: A tick of the full store is over the budget (%.2f us > %.2f us)", time_tick, BENCHMARK_ENTITIES_BUDGET);
+        return false;
+    }
+
+    return true;
+}
+
+bool benchmarkGrid() {
+    // The same density of the entities is spread over a longer and longer world (as it would be in the game), and at every count
+    // the grid is built and queried with the player-sized rectangles (the pickups) and with the entities' own circles (the neighbours).
+    // The brute-force loops over the whole store are measured as well, and every query must find exactly what the brute force finds.
+    // The grid's query should cost the same at any count (the brute force grows with the count).
+    const int COUNTS[3] = { ENTITY_CAPACITY / 16, ENTITY_CAPACITY / 4, ENTITY_CAPACITY };
+    const int BRUTE_FORCE_QUERIES = BENCHMARK_GRID_QUERIES / 10; // (It's slow enough at the full store)
+    const int BUILDS = 100;
+
+    EntityStore* store = MemAlloc(sizeof(EntityStore));
+    SpatialGrid* grid = MemAlloc(sizeof(SpatialGrid));
+    int* results = MemAlloc(sizeof(int) * ENTITY_CAPACITY);
+    Random random = randomInit(1);
+
+    double query_costs[3] = { 0 };
+    bool valid = true;
+
+    TraceLog(LOG_INFO, "BENCHMARK: Spatial grid (%i entities per screen, %i queries per count)", BENCHMARK_GRID_DENSITY, BENCHMARK_GRID_QUERIES);
+
+    for(int run = 0; run < 3; run++) {
+        int count = COUNTS[run];
+        float world_width = worldGetSize().x * count / BENCHMARK_GRID_DENSITY;
+
+        memset(store, 0, sizeof(EntityStore));
+
+        for(int i = 0; i < count; i++) {
+            Entity entity = {
+                .position = { randomGetValue(&random, 0, world_width), randomGetValue(&random, 0, WORLD_HEIGHT) },
+                .radius = COLLECTLIBLE_RADIUS
+            };
+
+            entityStoreAdd(store, entity);
+        }
+
+        double start = harnessGetTime();
+
+        for(int build = 0; build < BUILDS; build++) {
+            spatialGridBuild(grid, store);
+        }
+
+        double time_build = (harnessGetTime() - start) / BUILDS;
+
+        // The player-sized queries through the grid...
+        Random query_random = randomInit(run + 1);
+        long long hits = 0;
+
+        start = harnessGetTime();
+
+        for(int query = 0; query < BENCHMARK_GRID_QUERIES; query++) {
+            Rectangle rect = { randomGetValue(&query_random, 0, world_width), randomGetValue(&query_random, 0, WORLD_HEIGHT), 64.0f, 64.0f };
+            hits += spatialGridQuery(grid, rect, results, ENTITY_CAPACITY);
+        }
+
+        double time_query = (harnessGetTime() - start);
+
+        // ... and the first of them once more, compared with the brute force
+        query_random = randomInit(run + 1);
+        double time_brute_force = 0.0;
+
+        for(int query = 0; query < BRUTE_FORCE_QUERIES; query++) {
+            Rectangle rect = { randomGetValue(&query_random, 0, world_width), randomGetValue(&query_random, 0, WORLD_HEIGHT), 64.0f, 64.0f };
+            int found_grid = spatialGridQuery(grid, rect, results, ENTITY_CAPACITY);
+            int found_brute_force = 0;
+
+            start = harnessGetTime();
+
+            for(int i = 0; i < store->count; i++) {
+                found_brute_force += collisionCheckCircleRec(store->position[i], store->radius[i], rect);
+            }
+
+            time_brute_force += (harnessGetTime() - start);
+            valid &= found_grid == found_brute_force;
+        }
+
+        // The neighbours of every entity (every pair is found twice, and every entity finds itself)
+        long long neighbours_grid = 0;
+        long long neighbours_brute_force = 0;
+
+        start = harnessGetTime();
+
+        for(int i = 0; i < store->count; i++) {
+            neighbours_grid += spatialGridQueryCircle(grid, store->position[i], store->radius[i], results, ENTITY_CAPACITY) - 1;
+        }
+
+        double time_neighbours = (harnessGetTime() - start);
+
+        for(int i = 0; i < store->count; i++) {
+            for(int j = 0; j < store->count; j++) {
+                float distance_x = store->position[i].x - store->position[j].x;
+                float distance_y = store->position[i].y - store->position[j].y;
+                float distance_max = store->radius[i] + store->radius[j];
+
+                neighbours_brute_force += i != j && distance_x * distance_x + distance_y * distance_y <= distance_max * distance_max;
+            }
+        }
+
+        valid &= neighbours_grid == neighbours_brute_force;
+
+        query_costs[run] = time_query * 1e9 / BENCHMARK_GRID_QUERIES;
+
+        TraceLog(LOG_INFO, "BENCHMARK: > %4i entities: build %7.2f us, query %6.1f ns (brute force: %8.1f ns), neighbours %6.1f ns / entity, %lli hits, %lli neighbour pairs", 
+            count,
+            time_build * 1000000.0,
+            query_costs[run],
+            time_brute_force * 1e9 / BRUTE_FORCE_QUERIES,
+            time_neighbours * 1e9 / count,
+            hits,
+            neighbours_grid / 2
+        );
+    }
+
+    MemFree(results);
+    MemFree(grid);
+    MemFree(store);
+
+    if(!valid) {
+        TraceLog(LOG_ERROR, "BENCHMARK: The grid's queries don't match the brute force");
+        return false;
+    }
+
+    if(query_costs[2] > query_costs[0] * BENCHMARK_GRID_TOLERANCE) {
+        TraceLog(LOG_ERROR, "BENCHMARK: The query grows with the entity count (%.1f ns at %i, %.1f ns at %i)", query_costs[0], COUNTS[0], query_costs[2], COUNTS[2]);
+        return false;
+    }
+
+    return true;
+}